@@ -0,0 +1,108 @@
+#ifndef BANDWIDTH_H
+#define BANDWIDTH_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+#include "benchmark_kernels.h"
+#include "chase.h"
+
+/* Throughput of X-Mem's kernels on a generated list
+ * ==================================================
+ *
+ * X-Mem's sequential and random read/write kernels, run over the list a
+ * generator has built, so that one buffer is characterized for both
+ * latency (by the chase) and bandwidth. Each call of a kernel covers
+ * XMEM_KERNEL_BYTES: the sequential kernels stream that much from start
+ * to end in 64-bit words (so we only cover the largest multiple of it
+ * in the list), the random kernels follow 512 pointers of the chain.
+ * As in X-Mem, a random hop counts as one 64-bit word transferred,
+ * whatever the node size.
+ *
+ * The random write kernel writes each pointer back unchanged, but the
+ * sequential write kernels overwrite the list with a constant, which
+ * destroys the chain; measure_bandwidth() therefore runs them last.
+ */
+
+static const int64_t XMEM_KERNEL_BYTES = 4096;
+
+/* all in GB/s, 0 if the list is shorter than one kernel call */
+struct bandwidth_result {
+    double forward_read;
+    double reverse_read;
+    double random_read;
+    double random_write;
+    double forward_write;
+    double reverse_write;
+};
+
+/* time f(), which transfers bytes bytes, in GB/s */
+template<class F> double time_bytes(F f, int64_t bytes) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+
+    return bytes / std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+/* one untimed pass of kernel over [start; start + bytes), then timed
+ * passes over at least min_bytes in total */
+inline double timed_sequential(xmem::SequentialFunction kernel, void * start,
+	int64_t bytes, int64_t min_bytes) {
+    bytes -= bytes % XMEM_KERNEL_BYTES;
+    if(bytes <= 0)
+	return 0;
+
+    void * end = (char *) start + bytes;
+    int64_t passes = std::max<int64_t>((min_bytes + bytes - 1) / bytes, 1);
+
+    kernel(start, end);
+
+    return time_bytes([&]() {
+	for(int64_t i = 0; i < passes; i++)
+	    kernel(start, end);
+    }, passes * bytes);
+}
+
+/* at least hops hops along the chain from head, in calls of kernel */
+inline double timed_random(xmem::RandomFunction kernel, uint64_t * head,
+	int64_t hops) {
+    const int64_t hops_per_call = XMEM_KERNEL_BYTES / sizeof(uint64_t);
+    int64_t calls = std::max<int64_t>((hops + hops_per_call - 1) / hops_per_call, 1);
+    uintptr_t * p = (uintptr_t *) head;
+
+    double r = time_bytes([&]() {
+	for(int64_t i = 0; i < calls; i++)
+	    kernel(p, &p, XMEM_KERNEL_BYTES);
+    }, calls * XMEM_KERNEL_BYTES);
+    g_chase_sink = (uint64_t *) p;
+
+    return r;
+}
+
+/* All six kernels on the list of bytes bytes at list, whose chain
+ * starts at head (and which is warm, e.g., from a chase). The random
+ * kernels take at least min_hops hops, the sequential ones stream at
+ * least min_bytes. Overwrites the list. */
+inline bandwidth_result measure_bandwidth(uint64_t * head, void * list,
+	int64_t bytes, int64_t min_hops, int64_t min_bytes) {
+    bandwidth_result r;
+
+    r.random_read = timed_random(xmem::randomRead_Word64, head, min_hops);
+    r.random_write = timed_random(xmem::randomWrite_Word64, head, min_hops);
+    r.forward_read = timed_sequential(xmem::forwSequentialRead_Word64, list,
+	bytes, min_bytes);
+    r.reverse_read = timed_sequential(xmem::revSequentialRead_Word64, list,
+	bytes, min_bytes);
+
+    /* the chain is gone after these */
+    r.forward_write = timed_sequential(xmem::forwSequentialWrite_Word64, list,
+	bytes, min_bytes);
+    r.reverse_write = timed_sequential(xmem::revSequentialWrite_Word64, list,
+	bytes, min_bytes);
+
+    return r;
+}
+
+#endif
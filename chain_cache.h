@@ -0,0 +1,166 @@
+#ifndef CHAIN_CACHE_H
+#define CHAIN_CACHE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* On-disk cache of generated chains
+ * =================================
+ *
+ * cached_generator<T> behaves like generator T, but stores each chain it
+ * generates in a file, as the index of each node's successor, which does
+ * not depend on where the list is mapped. When a later run asks for the
+ * same chain (same generator, N, node size, seed, and the other options
+ * that shape the chain), it maps the file and relocates the indices into
+ * pointers in one sequential pass, instead of generating the chain.
+ *
+ * The files live in $CHAIN_CACHE_DIR, or in ./chain_cache by default.
+ * Generators whose output does not depend on the seed alone (X-Mem's)
+ * declare so with reproducible = false and are never cached.
+ */
+
+struct chain_file_header {
+    char magic[8];
+    uint64_t N;
+    uint64_t node_bytes;
+    uint64_t index_bytes; /* size of one successor index */
+};
+
+static const char CHAIN_FILE_MAGIC[8] = { 'P', 'C', 'H', 'A', 'I', 'N', '0', '1' };
+
+template<class T> class cached_generator : public T {
+protected:
+    std::string path() const {
+	const char * dir = getenv("CHAIN_CACHE_DIR");
+	std::ostringstream s;
+
+	s << (dir ? dir : "chain_cache") << "/" << typeid(T).name();
+	s << "_N" << this->N << "_n" << this->opts.node_bytes;
+	s << "_s" << this->opts.seed << "_t" << this->opts.threads;
+	s << "_p" << this->opts.page_bytes << "x" << this->opts.window_pages;
+	s << "_m" << this->opts.min_stride_lines << "x" << this->opts.min_stride_pages;
+	s << ".chain";
+
+	return s.str();
+    }
+
+    /* relocate the chain from the file into the list; false if there is
+     * no (valid) file */
+    bool load(const std::string & file) {
+	int fd = open(file.c_str(), O_RDONLY);
+	if(fd < 0)
+	    return false;
+
+	struct stat st;
+	size_t bytes = sizeof(chain_file_header) + (size_t) this->N * sizeof(uint32_t);
+
+	if(fstat(fd, &st) || (size_t) st.st_size != bytes) {
+	    close(fd);
+	    return false;
+	}
+
+	void * map = mmap(NULL, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(map == MAP_FAILED)
+	    return false;
+
+	madvise(map, bytes, MADV_SEQUENTIAL);
+
+	const chain_file_header * h = (const chain_file_header *) map;
+	const uint32_t * successor = (const uint32_t *) (h + 1);
+	bool valid = memcmp(h->magic, CHAIN_FILE_MAGIC, sizeof(h->magic)) == 0 &&
+	    h->N == (uint64_t) this->N &&
+	    h->node_bytes == (uint64_t) this->opts.node_bytes &&
+	    h->index_bytes == sizeof(uint32_t);
+
+	for(int i = 0; valid && i < this->N; i++) {
+	    if(successor[i] >= (uint32_t) this->N)
+		valid = false;
+	    else
+		*this->node(i) = (uint64_t) this->node(successor[i]);
+	}
+
+	munmap(map, bytes);
+
+	return valid;
+    }
+
+    /* write via a temporary file, so that concurrent runs never see a
+     * partial chain */
+    void store(const std::string & file) {
+	std::string tmp = file + ".tmp" + std::to_string(getpid());
+	FILE * f = fopen(tmp.c_str(), "wb");
+
+	if(!f) {
+	    std::cerr << "warning: cannot write " << tmp << std::endl;
+	    return;
+	}
+
+	chain_file_header h;
+	memcpy(h.magic, CHAIN_FILE_MAGIC, sizeof(h.magic));
+	h.N = this->N;
+	h.node_bytes = this->opts.node_bytes;
+	h.index_bytes = sizeof(uint32_t);
+
+	bool ok = fwrite(&h, sizeof(h), 1, f) == 1;
+
+	std::vector<uint32_t> buffer;
+	buffer.reserve(1 << 16);
+
+	for(int i = 0; ok && i < this->N; i++) {
+	    uint64_t * next = (uint64_t *) *this->node(i);
+	    buffer.push_back((uint32_t) ((next - this->list) / this->node_words));
+
+	    if(buffer.size() == buffer.capacity() || i == this->N - 1) {
+		ok = fwrite(buffer.data(), sizeof(uint32_t), buffer.size(), f) ==
+		    buffer.size();
+		buffer.clear();
+	    }
+	}
+
+	if(fclose(f) || !ok || rename(tmp.c_str(), file.c_str())) {
+	    std::cerr << "warning: cannot write " << file << std::endl;
+	    unlink(tmp.c_str());
+	}
+    }
+
+public:
+    using T::T;
+
+    static std::string name() { return "cached_" + T::name(); }
+
+    uint64_t * getlist() {
+
+	if(!T::reproducible)
+	    return T::getlist();
+
+	std::string file = path();
+
+	if(load(file))
+	    return this->list;
+
+	uint64_t * head = T::getlist();
+	if(!head)
+	    return head;
+
+	const char * dir = getenv("CHAIN_CACHE_DIR");
+	mkdir(dir ? dir : "chain_cache", 0777);
+	store(file);
+
+	return head;
+    }
+};
+
+#endif
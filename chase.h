@@ -0,0 +1,294 @@
+#ifndef CHASE_H
+#define CHASE_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAS_RDTSC
+#endif
+
+/* Pointer chasing kernels
+ * =======================
+ *
+ * Each hop is a load whose address depends on the previous load, so the
+ * time per hop is the load-to-use latency of wherever the chain lives.
+ * Like X-Mem's chasePointers, the loop body is unrolled so that loop
+ * control is negligible.
+ */
+
+#define CHASE_HOP(p) p = (uint64_t *) *p;
+#define UNROLL4(x) x x x x
+#define UNROLL16(x) UNROLL4(UNROLL4(x))
+#define UNROLL32(x) UNROLL16(x) UNROLL16(x)
+
+static const int CHASE_UNROLL = 32;
+
+/* follow the chain starting at p for the given number of hops, and
+ * return where we ended up */
+inline uint64_t * chase(uint64_t * p, int64_t hops) {
+
+    for(int64_t i = hops / CHASE_UNROLL; i > 0; i--) {
+	UNROLL32(CHASE_HOP(p))
+    }
+
+    for(int64_t i = hops % CHASE_UNROLL; i > 0; i--) {
+	CHASE_HOP(p)
+    }
+
+    return p;
+}
+
+/* the last node a chase ended on, so that the compiler cannot drop the
+ * chase as dead code */
+extern uint64_t * volatile g_chase_sink;
+
+inline uint64_t read_ticks() {
+#ifdef HAS_RDTSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+struct chase_result {
+    int64_t hops;
+    double ns_per_hop;
+    double ticks_per_hop; /* TSC ticks, 0 without a TSC */
+};
+
+/* time f(), which chases for hops hops in total */
+template<class F> chase_result time_hops(F f, int64_t hops) {
+    chase_result r;
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t t0 = read_ticks();
+    f();
+    uint64_t t1 = read_ticks();
+    auto end = std::chrono::steady_clock::now();
+
+    r.hops = hops;
+    r.ns_per_hop = std::chrono::duration<double, std::nano>(end - start).count() / hops;
+    r.ticks_per_hop = (double) (t1 - t0) / hops;
+
+    return r;
+}
+
+/* One untimed pass over warmup_hops hops to bring the chain into the
+ * caches and TLBs, then a timed chase of hops hops. */
+inline chase_result timed_chase(uint64_t * head, int64_t hops,
+	int64_t warmup_hops) {
+    uint64_t * p = chase(head, warmup_hops);
+
+    chase_result r = time_hops([&]() { p = chase(p, hops); }, hops);
+    g_chase_sink = p;
+
+    return r;
+}
+
+/* Sampled chase
+ * =============
+ *
+ * For the distribution of hop latencies rather than their mean, the
+ * chase can take a timestamp after every every-th hop and store the
+ * ticks since the previous one in a preallocated ring buffer. The
+ * timestamps do not depend on the chain, which stays a plain sequence
+ * of dependent loads; an lfence before each waits for the last hop to
+ * arrive. That adds a few dozen cycles per sample, which
+ * sample_overhead() measures, so that it can be subtracted.
+ */
+
+/* TSC ticks, or nanoseconds without a TSC */
+inline uint64_t read_fenced_ticks() {
+#ifdef HAS_RDTSC
+    _mm_lfence();
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+	std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/* the least ticks between two timestamps without work in between */
+inline uint64_t sample_overhead() {
+    uint64_t least = UINT64_MAX;
+
+    for(int i = 0; i < 1000; i++) {
+	uint64_t t0 = read_fenced_ticks();
+	uint64_t t1 = read_fenced_ticks();
+	least = std::min(least, t1 - t0);
+    }
+
+    return least;
+}
+
+struct sample_ring {
+    std::vector<uint32_t> ticks; /* per sample, saturated */
+    int64_t samples; /* in total; the ring holds the last ticks.size() */
+
+    explicit sample_ring(size_t size) : ticks(size), samples(0) { }
+};
+
+/* chase for hops hops (a multiple of every) from p, sampling after
+ * every every-th hop, and return where we ended up */
+inline uint64_t * sampled_chase(uint64_t * p, int64_t hops, int every,
+	sample_ring & ring) {
+    uint32_t * buffer = ring.ticks.data();
+    int64_t size = (int64_t) ring.ticks.size();
+    int64_t slot = ring.samples % size;
+    int64_t samples = hops / every;
+    uint64_t t = read_fenced_ticks();
+
+    for(int64_t i = samples; i > 0; i--) {
+	p = chase(p, every);
+
+	uint64_t now = read_fenced_ticks();
+	buffer[slot] = (uint32_t) std::min<uint64_t>(now - t, UINT32_MAX);
+	if(++slot == size)
+	    slot = 0;
+	t = now;
+    }
+
+    ring.samples += samples;
+
+    return p;
+}
+
+/* Chains of indices
+ * =================
+ *
+ * Instead of a pointer, each node may hold the position of its successor
+ * as an index into the list (in entries of I from the list's base), or
+ * as an offset relative to its own position (modulo 2^(8 * sizeof(I))).
+ * Either way, the chain does not depend on where the list is mapped,
+ * and with 32-bit entries, nodes can be half as large as with pointers.
+ * Each hop is still a single dependent load, with base+index addressing.
+ */
+
+#define CHASE_INDEX_HOP(base, i) i = base[i];
+#define CHASE_OFFSET_HOP(base, i) i += base[i];
+
+template<class I> inline I chase_index(const I * base, I i, int64_t hops) {
+
+    for(int64_t n = hops / CHASE_UNROLL; n > 0; n--) {
+	UNROLL32(CHASE_INDEX_HOP(base, i))
+    }
+
+    for(int64_t n = hops % CHASE_UNROLL; n > 0; n--) {
+	CHASE_INDEX_HOP(base, i)
+    }
+
+    return i;
+}
+
+template<class I> inline I chase_offset(const I * base, I i, int64_t hops) {
+
+    for(int64_t n = hops / CHASE_UNROLL; n > 0; n--) {
+	UNROLL32(CHASE_OFFSET_HOP(base, i))
+    }
+
+    for(int64_t n = hops % CHASE_UNROLL; n > 0; n--) {
+	CHASE_OFFSET_HOP(base, i)
+    }
+
+    return i;
+}
+
+/* as timed_chase(), for the chain of indices (or relative offsets) that
+ * starts at entry 0 of base */
+template<class I> chase_result timed_index_chase(const I * base,
+	bool relative, int64_t hops, int64_t warmup_hops) {
+    I i = 0;
+    chase_result r;
+
+    if(relative) {
+	i = chase_offset(base, i, warmup_hops);
+	r = time_hops([&]() { i = chase_offset(base, i, hops); }, hops);
+    } else {
+	i = chase_index(base, i, warmup_hops);
+	r = time_hops([&]() { i = chase_index(base, i, hops); }, hops);
+    }
+
+    g_chase_sink = (uint64_t *) (base + i);
+
+    return r;
+}
+
+/* Advance K independent chains in lockstep, hops hops each. The K loads
+ * of one step do not depend on each other, so up to K misses can be in
+ * flight at a time, which measures the memory-level parallelism the
+ * core sustains. */
+template<int K> void chase_lockstep(uint64_t ** heads, int64_t hops) {
+    uint64_t * p[K];
+
+    for(int j = 0; j < K; j++)
+	p[j] = heads[j];
+
+    /* one hop of every chain per step, so that chain 0 advances again
+     * after K loads rather than 4K */
+    for(int64_t i = hops / 4; i > 0; i--) {
+	for(int step = 0; step < 4; step++) {
+	    for(int j = 0; j < K; j++) {
+		CHASE_HOP(p[j])
+	    }
+	}
+    }
+
+    for(int64_t i = hops % 4; i > 0; i--) {
+	for(int j = 0; j < K; j++) {
+	    CHASE_HOP(p[j])
+	}
+    }
+
+    for(int j = 0; j < K; j++)
+	heads[j] = p[j];
+}
+
+static const int MAX_LOCKSTEP_CHAINS = 32;
+
+typedef void (*lockstep_kernel)(uint64_t ** heads, int64_t hops);
+
+/* table[K] = chase_lockstep<K>, for 1 <= K <= MAX_LOCKSTEP_CHAINS */
+template<int K> struct lockstep_table {
+    static void fill(lockstep_kernel * table) {
+	table[K] = chase_lockstep<K>;
+	lockstep_table<K - 1>::fill(table);
+    }
+};
+
+template<> struct lockstep_table<0> {
+    static void fill(lockstep_kernel *) { }
+};
+
+struct lockstep_kernels {
+    lockstep_kernel table[MAX_LOCKSTEP_CHAINS + 1];
+
+    lockstep_kernels() {
+	table[0] = NULL;
+	lockstep_table<MAX_LOCKSTEP_CHAINS>::fill(table);
+    }
+};
+
+/* Chase heads.size() chains in lockstep, hops hops each, after a warm-up
+ * of warmup_hops hops each. ns_per_hop is the aggregate over all chains,
+ * i.e., the inverse of the hop throughput. */
+inline chase_result timed_lockstep_chase(std::vector<uint64_t *> heads,
+	int64_t hops, int64_t warmup_hops) {
+    static const lockstep_kernels kernels;
+
+    int K = (int) heads.size();
+    lockstep_kernel kernel = kernels.table[K];
+
+    kernel(heads.data(), warmup_hops);
+
+    chase_result r = time_hops([&]() { kernel(heads.data(), hops); },
+	hops * K);
+    g_chase_sink = heads[0];
+
+    return r;
+}
+
+#endif
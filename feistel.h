@@ -0,0 +1,91 @@
+#ifndef FEISTEL_H
+#define FEISTEL_H
+
+#include <cstdint>
+
+#include "rng.h"
+
+/* Keyed bijection on [0, N)
+ * =========================
+ *
+ * A balanced Feistel network permutes [0, 2^(2h)) for the smallest h
+ * with 2^(2h) >= N; cycle-walking (applying it again while the result
+ * is out of range) restricts that to a permutation of [0, N). As
+ * 2^(2h) < 4N, that takes fewer than four rounds of the network on
+ * average. The permutation only depends on N and the seed, and needs
+ * no memory besides the round keys, so any value and its inverse can
+ * be computed in O(1), on any thread and on any host.
+ */
+
+class feistel_permutation {
+public:
+    static const int ROUNDS = 6;
+
+private:
+    uint64_t N;
+    int half_bits;
+    uint64_t mask; /* of one half */
+    uint64_t keys[ROUNDS];
+
+    /* the round function, the finalizer of splitmix64 */
+    uint64_t f(int round, uint64_t x) const {
+	uint64_t z = x ^ keys[round];
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return (z ^ (z >> 31)) & mask;
+    }
+
+    uint64_t encrypt(uint64_t x) const {
+	uint64_t l = x >> half_bits, r = x & mask;
+
+	for(int i = 0; i < ROUNDS; i++) {
+	    uint64_t t = l ^ f(i, r);
+	    l = r;
+	    r = t;
+	}
+
+	return (l << half_bits) | r;
+    }
+
+    uint64_t decrypt(uint64_t x) const {
+	uint64_t l = x >> half_bits, r = x & mask;
+
+	for(int i = ROUNDS - 1; i >= 0; i--) {
+	    uint64_t t = r ^ f(i, l);
+	    r = l;
+	    l = t;
+	}
+
+	return (l << half_bits) | r;
+    }
+
+public:
+    feistel_permutation(uint64_t N, uint64_t seed) : N(N), half_bits(1) {
+	while(((uint64_t) 1 << (2 * half_bits)) < N)
+	    half_bits++;
+	mask = ((uint64_t) 1 << half_bits) - 1;
+
+	splitmix64_rng sm(seed);
+	for(int i = 0; i < ROUNDS; i++)
+	    keys[i] = sm();
+    }
+
+    /* the image of x in [0, N) */
+    uint64_t operator()(uint64_t x) const {
+	do
+	    x = encrypt(x);
+	while(x >= N);
+
+	return x;
+    }
+
+    uint64_t inverse(uint64_t y) const {
+	do
+	    y = decrypt(y);
+	while(y >= N);
+
+	return y;
+    }
+};
+
+#endif
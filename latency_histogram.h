@@ -0,0 +1,112 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+/* Log-linear histogram of latencies
+ * =================================
+ *
+ * In the manner of HdrHistogram: values (non-negative integers, e.g.,
+ * TSC ticks) below 2^SUB_BITS each have a bucket of their own, and every
+ * power of two above is split into 2^SUB_BITS equally wide buckets. So
+ * any value is recorded within a relative error of 2^-SUB_BITS (1/128),
+ * from a few cycles (L1 hits) up to page walks, remote accesses and
+ * interrupts, with a fixed 60 KiB of counters.
+ */
+
+class latency_histogram {
+public:
+    static const int SUB_BITS = 7;
+
+private:
+    static const int64_t SUB = (int64_t) 1 << SUB_BITS;
+
+    std::vector<int64_t> counts;
+    int64_t total;
+    uint64_t max_value;
+
+    static int bucket(uint64_t v) {
+	if(v < (uint64_t) SUB)
+	    return (int) v;
+
+	int shift = (63 - __builtin_clzll(v)) - SUB_BITS;
+
+	return (int) ((shift + 1) * SUB + (int64_t) (v >> shift) - SUB);
+    }
+
+public:
+    latency_histogram() : counts(bucket(UINT64_MAX) + 1, 0), total(0),
+	max_value(0) { }
+
+    void add(uint64_t v) {
+	counts[bucket(v)] ++;
+	total ++;
+	if(v > max_value)
+	    max_value = v;
+    }
+
+    int64_t count() const { return total; }
+    uint64_t max() const { return max_value; }
+
+    /* the smallest value of bucket i, and its width */
+    static uint64_t lower(int i) {
+	if(i < SUB)
+	    return i;
+
+	int shift = (int) (i / SUB) - 1;
+
+	return (uint64_t) (i % SUB + SUB) << shift;
+    }
+
+    static uint64_t width(int i) {
+	return (i < SUB) ? 1 : (uint64_t) 1 << ((i / SUB) - 1);
+    }
+
+    /* the value below which p percent of the values lie, p in [0; 100],
+     * as the middle of its bucket */
+    double percentile(double p) const {
+	if(!total)
+	    return 0;
+
+	int64_t rank = (int64_t) (p / 100 * total);
+	if(rank >= total)
+	    rank = total - 1;
+
+	int64_t seen = 0;
+	for(int i = 0; i < (int) counts.size(); i++) {
+	    seen += counts[i];
+	    if(seen > rank)
+		return lower(i) + (width(i) - 1) / 2.0;
+	}
+
+	return max_value;
+    }
+
+    /* the percentile spectrum up to 99.999%, in two steps per halving of
+     * the distance to 100%, as HdrHistogram prints it, with values scaled
+     * by scale (e.g., ns per tick) */
+    void print(std::ostream & out, double scale, const char * unit) const {
+	out << std::setw(14) << unit << std::setw(14) << "percentile";
+	out << std::setw(14) << "1/(1-p)" << std::endl;
+
+	for(double tail = 1; total && tail * total >= 1 && tail > 1e-5; tail /= 2) {
+	    for(int step = 0; step < 2; step++) {
+		double p = 100 * (1 - tail + tail / 2 * step / 2);
+		if(p > 100 - 100.0 / total)
+		    break;
+
+		out << std::setw(14) << percentile(p) * scale;
+		out << std::setw(14) << p;
+		out << std::setw(14) << 1 / (1 - p / 100) << std::endl;
+	    }
+	}
+
+	out << std::setw(14) << max_value * scale << std::setw(14) << 100;
+	out << std::setw(14) << "inf" << std::endl;
+    }
+};
+
+#endif
@@ -0,0 +1,162 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "list_allocator.h"
+
+/* from <numaif.h>; we issue the system call directly to avoid depending
+ * on libnuma */
+#ifndef MPOL_BIND
+#define MPOL_BIND 2
+#endif
+#ifndef MPOL_MF_STRICT
+#define MPOL_MF_STRICT (1 << 0)
+#endif
+#ifndef MPOL_MF_MOVE
+#define MPOL_MF_MOVE (1 << 1)
+#endif
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+
+static const size_t SMALL_PAGE = 4096;
+static const size_t HUGE_2MiB = 2 << 20;
+static const size_t HUGE_1GiB = 1 << 30;
+
+static size_t page_size(page_policy_t pages) {
+    switch(pages) {
+    case PAGES_THP:
+    case PAGES_HUGETLB_2MiB:
+	return HUGE_2MiB;
+    case PAGES_HUGETLB_1GiB:
+	return HUGE_1GiB;
+    default:
+	return SMALL_PAGE;
+    }
+}
+
+size_t list_allocator::mapped_size(size_t bytes) const {
+    size_t page = page_size(pages);
+
+    return (std::max(bytes, (size_t) 1) + page - 1) / page * page;
+}
+
+/* map len bytes aligned to align, by over-allocating and trimming */
+static void * map_aligned(size_t len, size_t align) {
+    void * p = mmap(NULL, len + align, PROT_READ | PROT_WRITE,
+	MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if(p == MAP_FAILED)
+	return NULL;
+
+    uintptr_t start = (uintptr_t) p;
+    uintptr_t aligned = (start + align - 1) / align * align;
+
+    if(aligned > start)
+	munmap(p, aligned - start);
+    if(start + align > aligned)
+	munmap((void *) (aligned + len), start + align - aligned);
+
+    return (void *) aligned;
+}
+
+void * list_allocator::allocate(size_t bytes) const {
+    size_t len = mapped_size(bytes);
+    void * p = NULL;
+
+    if(pages == PAGES_HUGETLB_2MiB || pages == PAGES_HUGETLB_1GiB) {
+	int shift = (pages == PAGES_HUGETLB_2MiB) ? 21 : 30;
+
+	p = mmap(NULL, len, PROT_READ | PROT_WRITE,
+	    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB |
+	    (shift << MAP_HUGE_SHIFT), -1, 0);
+
+	if(p == MAP_FAILED) {
+	    std::cerr << "warning: no hugetlb pages of " << page_size(pages)
+		<< " bytes available, using transparent huge pages"
+		<< std::endl;
+	    p = NULL;
+	}
+    }
+
+    if(!p) {
+	p = map_aligned(len, (pages == PAGES_DEFAULT) ? SMALL_PAGE : HUGE_2MiB);
+
+	if(!p) {
+	    std::cerr << "failed to map " << len << " bytes" << std::endl;
+	    exit(EXIT_FAILURE);
+	}
+
+	if(pages != PAGES_DEFAULT)
+	    madvise(p, len, MADV_HUGEPAGE);
+    }
+
+    if(numa_node >= 0) {
+	const int bits = 8 * sizeof(unsigned long);
+	std::vector<unsigned long> nodemask(numa_node / bits + 1, 0);
+	nodemask[numa_node / bits] = 1UL << (numa_node % bits);
+
+	if(syscall(SYS_mbind, p, len, MPOL_BIND, nodemask.data(),
+		nodemask.size() * bits + 1, MPOL_MF_STRICT | MPOL_MF_MOVE))
+	    std::cerr << "warning: cannot bind memory to node "
+		<< numa_node << std::endl;
+    }
+
+    if(prefault) {
+	/* fault in by writing, after the binding took effect; touching a
+	 * page every 4 KiB covers huge pages as well */
+	volatile char * c = (volatile char *) p;
+	for(size_t i = 0; i < len; i += SMALL_PAGE)
+	    c[i] = 0;
+    }
+
+    return p;
+}
+
+void list_allocator::release(void * p, size_t bytes) const {
+    if(p)
+	munmap(p, mapped_size(bytes));
+}
+
+scratch_arena::scratch_arena(const list_allocator & list_alloc) {
+    alloc.pages = (list_alloc.pages == PAGES_DEFAULT) ? PAGES_DEFAULT : PAGES_THP;
+    alloc.numa_node = list_alloc.numa_node;
+    alloc.prefault = list_alloc.prefault;
+}
+
+scratch_arena::~scratch_arena() {
+    for(size_t i = 0; i < buffers.size(); i++)
+	alloc.release(buffers[i], sizes[i]);
+}
+
+void * scratch_arena::get(int slot, size_t bytes) {
+    if((size_t) slot >= buffers.size()) {
+	buffers.resize(slot + 1, NULL);
+	sizes.resize(slot + 1, 0);
+    }
+
+    if(!buffers[slot] || sizes[slot] < bytes) {
+	alloc.release(buffers[slot], sizes[slot]);
+	buffers[slot] = alloc.allocate(bytes);
+	sizes[slot] = bytes;
+    }
+
+    return buffers[slot];
+}
+
+size_t scratch_arena::mapped_bytes() const {
+    size_t total = 0;
+
+    for(size_t i = 0; i < buffers.size(); i++)
+	if(buffers[i])
+	    total += alloc.mapped_size(sizes[i]);
+
+    return total;
+}
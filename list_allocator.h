@@ -0,0 +1,68 @@
+#ifndef LIST_ALLOCATOR_H
+#define LIST_ALLOCATOR_H
+
+#include <cstddef>
+#include <vector>
+
+/* Backing memory for the pointer lists
+ * ====================================
+ *
+ * The lists are mapped with mmap, so that we can choose the page size,
+ * bind the memory to a NUMA node, and fault it in before the generator
+ * runs (instead of paying for first touch during generation and
+ * chasing).
+ */
+
+enum page_policy_t {
+    PAGES_DEFAULT, /* whatever the kernel chooses */
+    PAGES_THP, /* transparent huge pages, via madvise */
+    PAGES_HUGETLB_2MiB, /* explicit huge pages from the hugetlb pool */
+    PAGES_HUGETLB_1GiB
+};
+
+class list_allocator {
+public:
+    page_policy_t pages;
+    int numa_node; /* bind to this node, or -1 for no binding */
+    bool prefault; /* touch every page right after allocation */
+
+    list_allocator()
+	: pages(PAGES_DEFAULT), numa_node(-1), prefault(false) { }
+
+    /* Terminates the program when no memory can be mapped. Falls back to
+     * PAGES_THP (with a warning) when the hugetlb pool cannot satisfy the
+     * request. */
+    void * allocate(size_t bytes) const;
+    void release(void * p, size_t bytes) const;
+
+    /* bytes actually mapped for a request of the given size */
+    size_t mapped_size(size_t bytes) const;
+};
+
+/* Scratch memory of a generator, which persists across getlist() calls:
+ * get(slot, bytes) returns the buffer of the previous call with the same
+ * slot if it is large enough, so repeated runs do not pay for mapping
+ * and faulting in their scratch buffers again. Buffers take the NUMA
+ * node and prefaulting of the list's allocator, but never hugetlb pages
+ * (THP instead), so that a few KiB of scratch memory do not take whole
+ * pages from the reserved pool; they are released with the arena. */
+class scratch_arena {
+    list_allocator alloc;
+    std::vector<void *> buffers;
+    std::vector<size_t> sizes;
+
+public:
+    explicit scratch_arena(const list_allocator & list_alloc = list_allocator());
+
+    scratch_arena(const scratch_arena &) = delete;
+    scratch_arena & operator=(const scratch_arena &) = delete;
+
+    ~scratch_arena();
+
+    void * get(int slot, size_t bytes);
+
+    /* bytes mapped for all slots */
+    size_t mapped_bytes() const;
+};
+
+#endif
@@ -1,12 +1,42 @@
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
 #include <cinttypes>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
 #include <iomanip>
 #include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
 #include <random>
-#include <typeinfo>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
+#include <getopt.h>
+#include <unistd.h>
+
+#include "bandwidth.h"
 #include "benchmark_kernels.h"
+#include "chain_cache.h"
+#include "chase.h"
+#include "feistel.h"
+#include "latency_histogram.h"
 #include "common.h"
+#include "list_allocator.h"
+#include "perf_counters.h"
+#include "randomness_tests.h"
+#include "resources.h"
+#include "rng.h"
+#include "simd_kernels.h"
+#include "stride_histogram.h"
+#include "topology.h"
 
 /* Testsuite for generators of randomly permutated linked lists
  * ============================================================
@@ -15,68 +45,296 @@
  * (1) Maximum memory coverage of pointer chain: chasing pointers will
  *     visit all elements (i.e., the pointers form a hamiltonian cycle).
  * (2) Avoid regular stride: address distance between elements should be
- *     random (what distribution, actually??).
+ *     random (what distribution, actually??). We compare against that of
+ *     a uniformly random cyclic permutation; see randomness_tests.h.
  *
  * Test a generator for these properties
  *  1. generate permutation
  *  2. alloc and init stride histogram
  *  3. follow pointer chain until we return to the initial element
  *      (a) count visited elements
- *      (b) note each stride in the histogram.
+ *      (b) note each stride in the histogram and the randomness tests.
 */
 
 namespace xmem {
     bool g_verbose = false; /* needed by X-Mem source code */
 };
 
+uint64_t * volatile g_chase_sink;
+
+/* fixed default seed, so that runs can be reproduced */
+static const uint64_t DEFAULT_SEED = 0x5eed;
+
+/* Node sizes in bytes, named after X-Mem's chunk_size_t. Each node holds
+ * exactly one pointer (in its first word), so with nodes of at least a
+ * cache line every hop of the chase touches a different line. */
+enum node_size_t {
+    NODE_64b = 8,
+    NODE_128b = 16,
+    NODE_256b = 32,
+    NODE_512b = 64
+};
+
+/* the L1 data cache line size of this machine, usually NODE_512b */
+int cacheline_size() {
+    long size = sysconf(_SC_LEVEL1_DCACHE_LINESIZE);
+
+    return (size >= NODE_64b) ? (int) size : NODE_512b;
+}
+
+static const int64_t PAGE_4KiB = 4096;
+static const int64_t PAGE_2MiB = 2 << 20;
+static const int64_t PAGE_1GiB = 1 << 30;
+
+struct generator_options {
+    uint64_t seed;
+    int threads; /* for generators that use worker threads */
+    int node_bytes; /* a multiple of 8, e.g., a node_size_t */
+
+    /* for page_window_generator: the chain stays within a window of
+     * window_pages pages of page_bytes each before moving on */
+    int64_t page_bytes;
+    int window_pages;
+
+    /* for adversarial_generator: the minimum |stride|, in cache lines
+     * and in pages of page_bytes, whichever is longer */
+    int min_stride_lines;
+    int min_stride_pages;
+
+    list_allocator alloc; /* backing memory of the list */
+
+    generator_options()
+	: seed(DEFAULT_SEED), threads(std::thread::hardware_concurrency()),
+	  node_bytes(NODE_64b), page_bytes(PAGE_4KiB), window_pages(1),
+	  min_stride_lines(2), min_stride_pages(1) { }
+};
+
+/* Common state of the generators. Generators are used through templates
+ * only (never through a pointer to this class), so that every call is
+ * resolved at compile time; each one provides
+ *   uint64_t * getlist(), which builds the chain and returns its head,
+ *     or NULL if it cannot build one with these options,
+ *   static std::string name(), for output and the command line. */
 class permutated_list_generator {
 protected:
     int N;
     uint64_t * list;
+    generator_options opts;
+    int node_words; /* 64 bit words per node */
+    scratch_arena scratch; /* for the traversal order and the like */
+
+    /* start of the i-th node; the pointer to its successor goes here */
+    uint64_t * node(int i) { return list + (int64_t) i * node_words; }
+
+    /* count elements of scratch memory in the given slot */
+    template<class U> U * scratch_array(int slot, size_t count) {
+	return (U *) scratch.get(slot, count * sizeof(U));
+    }
 
 public:
-    permutated_list_generator(int N) : N(N) {
-	list = new uint64_t[N];
+    permutated_list_generator(int N,
+	    const generator_options & opts = generator_options())
+	: N(N), opts(opts), scratch(opts.alloc) {
+	node_words = std::max(opts.node_bytes / 8, 1);
+	this->opts.node_bytes = node_words * 8;
+	list = (uint64_t *) opts.alloc.allocate(list_bytes());
+    }
+
+    ~permutated_list_generator() {
+	opts.alloc.release(list, list_bytes());
     }
 
-    virtual ~permutated_list_generator() {
-	delete list;
+    size_t list_bytes() const { return (size_t) N * node_words * 8; }
+    size_t scratch_bytes() const { return scratch.mapped_bytes(); }
+
+    /* The next getlist() builds the chain anew with this seed, in the
+     * same list and scratch memory, which are faulted in already; every
+     * getlist() overwrites all nodes. */
+    void reseed(uint64_t seed) { opts.seed = seed; }
+
+    /* Split the cycle through head (from getlist()) into K disjoint
+     * cycles of about equal length, for chasing several chains in
+     * parallel; returns the head of each. Splitting a uniformly random
+     * cycle at fixed positions yields uniformly random cycles over
+     * random subsets of the nodes. */
+    std::vector<uint64_t *> split(uint64_t * head, int K) {
+	std::vector<uint64_t *> heads;
+
+	/* the length of the cycle through head, which is N unless the
+	 * generator produces several cycles */
+	int64_t length = 0;
+	uint64_t * p = head;
+	do {
+	    p = (uint64_t *) *p;
+	    length ++;
+	} while(p != head && length < N);
+
+	K = (int) std::max<int64_t>(std::min<int64_t>(K, length), 1);
+
+	p = head;
+	for(int k = 0; k < K; k++) {
+	    int64_t segment = length * (k + 1) / K - length * k / K;
+	    uint64_t * first = p;
+
+	    for(int64_t i = 1; i < segment; i++)
+		p = (uint64_t *) *p;
+
+	    /* close the segment into a cycle of its own */
+	    uint64_t * next = (uint64_t *) *p;
+	    *p = (uint64_t) first;
+	    p = next;
+
+	    heads.push_back(first);
+	}
+
+	return heads;
     }
 
     int getN() const { return N; }
+    int getNodeBytes() const { return opts.node_bytes; }
+
+    /* start of the list memory, which need not be the head of the chain */
+    uint64_t * getBase() const { return list; }
+
+    /* whether the chain depends only on N and opts (for caching) */
+    static const bool reproducible = true;
 
-    virtual uint64_t * getlist() = 0;
+    /* whether the generator can grow its chain with grow(n) */
+    static const bool growable = false;
 };
 
+/* for names of generators: the default RNG goes without saying */
+template<class RNG> std::string rng_suffix() {
+    return std::is_same<RNG, xoshiro256ss_rng>::value ? "" :
+	std::string("/") + RNG::name();
+}
+
 class XMem_list_generator : public permutated_list_generator {
 
 public:
-    XMem_list_generator(int N) : permutated_list_generator(N) { }
+    /* note that X-Mem seeds its generator with time(NULL), so
+     * opts.seed has no effect here */
+    static const bool reproducible = false;
+
+    static std::string name() { return "xmem"; }
+
+    XMem_list_generator(int N,
+	    const generator_options & opts = generator_options())
+	: permutated_list_generator(N, opts) { }
+
+    uint64_t * getlist() {
+
+	xmem::chunk_size_t chunk;
+
+	switch(opts.node_bytes) {
+	case NODE_64b:
+	    chunk = xmem::CHUNK_64b;
+	    break;
+#ifdef HAS_WORD_128
+	case NODE_128b:
+	    chunk = xmem::CHUNK_128b;
+	    break;
+#endif
+#ifdef HAS_WORD_256
+	case NODE_256b:
+	    chunk = xmem::CHUNK_256b;
+	    break;
+#endif
+	default:
+	    std::cerr << "X-Mem supports no chunks of " << opts.node_bytes
+		<< " bytes in this build" << std::endl;
+	    return NULL;
+	}
+
+	if(!xmem::build_random_pointer_permutation(list,
+		(void *) node(N-1), chunk)) {
+	    std::cerr << "X-Mem cannot build a permutation of " << N - 1
+		<< " chunks of " << opts.node_bytes << " bytes" << std::endl;
+	    return NULL;
+	}
+
+	return list;
+    }
+
+};
+
+/* X-Mem's permutation generally consists of several cycles (the example
+ * run shows an average coverage of the cycle through the head of about
+ * 45%). This generator keeps X-Mem's generator and repairs its output:
+ * it finds all cycles, with one bit of scratch memory per node, and
+ * splices them into one by swapping the successors of one node of each
+ * cycle with those of the first. That changes one pointer per cycle, and
+ * there are only about ln(N) cycles, so the stride distribution remains
+ * X-Mem's. */
+class XMem_spliced_list_generator : public XMem_list_generator {
+
+public:
+    static std::string name() { return "xmem_spliced"; }
+
+    XMem_spliced_list_generator(int N,
+	    const generator_options & opts = generator_options())
+	: XMem_list_generator(N, opts) { }
 
     uint64_t * getlist() {
 
-	xmem::build_random_pointer_permutation(list,
-	    (void *) &list[N-1], xmem::CHUNK_64b);
+	if(!XMem_list_generator::getlist())
+	    return NULL;
+
+	/* X-Mem leaves out the last node (we pass it as the end address),
+	 * so it becomes a cycle of its own */
+	*node(N-1) = (uint64_t) node(N-1);
+
+	uint64_t * visited = scratch_array<uint64_t>(0, (N + 63) / 64);
+	memset(visited, 0, (N + 63) / 64 * sizeof(uint64_t));
+	uint64_t * first = NULL;
+	uint64_t * end = node(N);
+
+	for(int i = 0; i < N; i++) {
+	    if(visited[i / 64] & (1ULL << (i % 64)))
+		continue;
+
+	    /* a new cycle: mark all its nodes */
+	    uint64_t * p = node(i);
+	    do {
+		int64_t j = (p - list) / node_words;
+		visited[j / 64] |= 1ULL << (j % 64);
+
+		p = (uint64_t *) *p;
+		if(p < list || p >= end || (p - list) % node_words) {
+		    std::cerr << "X-Mem chain leaves the list" << std::endl;
+		    return NULL;
+		}
+	    } while(p != node(i));
+
+	    if(first)
+		std::swap(*first, *node(i));
+	    else
+		first = node(i);
+	}
 
 	return list;
     }
 
 };
 
+template<class RNG = xoshiro256ss_rng>
 class external_shuffle_generator : public permutated_list_generator {
 
 public:
-    external_shuffle_generator(int N) : permutated_list_generator(N) { }
+    static std::string name() { return "external_shuffle" + rng_suffix<RNG>(); }
+
+    external_shuffle_generator(int N,
+	    const generator_options & opts = generator_options())
+	: permutated_list_generator(N, opts) { }
 
     uint64_t * getlist() {
 
 	/* represent the order in which we are going to traverse the
 	 * pointer nodes */
-	int * traversal_order = new int[N + 1];
+	uint32_t * traversal_order = scratch_array<uint32_t>(0, N + 1);
 
 	/* 0, 1, 2, ...., N-1 */
-	for(int i = 0; i < N; i++)
-	    traversal_order[i] = i;
+	iota_u32(traversal_order, N, 0);
 
 	/* and back to 0 */
 	traversal_order[N] = 0;
@@ -84,8 +342,7 @@ public:
 	/* at this point, traversal_order represents a hamiltonion
 	 * cycle, albeit a not very random one */
 
-	std::mt19937_64 gen(time(NULL)); //Mersenne Twister random number generator, seeded as in X-Mem
-	//std::minstd_rand0 gen(time(NULL)); // slightly faster alternative
+	RNG gen(opts.seed);
 
 	/* now we randomize the order in which we visit the nodes,
 	 * maintaining the invariants that
@@ -94,7 +351,7 @@ public:
 	 *     nodes 
 	 * For that purpose, we only shuffle the elements 1, 2, ..., N-1
 	 * in the middle */
-	std::shuffle(traversal_order + 1, traversal_order + (N - 1), gen);
+	rng_shuffle(traversal_order + 1, traversal_order + N, gen);
 
 	/* std::cout << std::endl;
 
@@ -103,171 +360,2591 @@ public:
 
 	std::cout << std::endl; */
 
-	/* implement the traversal order within the pointer array */
+	/* implement the traversal order within the pointer array, i.e.,
+	 * *node( traversal_order[i] ) = node( traversal_order[i+1] ) */
+	link_order(list, traversal_order, N, node_words);
+
+	return list;
+    }
+
+};
+
+template<class RNG = xoshiro256ss_rng>
+class sattolo_generator : public permutated_list_generator {
+
+public:
+    static std::string name() { return "sattolo" + rng_suffix<RNG>(); }
+
+    sattolo_generator(int N,
+	    const generator_options & opts = generator_options())
+	: permutated_list_generator(N, opts) { }
+
+    uint64_t * getlist() {
+
+	/* Sattolo's variant of the Fisher-Yates shuffle yields a
+	 * uniformly random cyclic permutation, i.e., one that consists
+	 * of a single cycle over all N elements. We run it directly on
+	 * the nodes, which thereby hold the index of their successor,
+	 * so we need no traversal_order buffer at all. */
+	iota_nodes(list, N, node_words);
+
+	RNG gen(opts.seed);
+
+	/* in contrast to Fisher-Yates, j is drawn from [0, i) and never
+	 * equals i: no element may be swapped with itself */
+	for(int i = N - 1; i > 0; i--)
+	    std::swap(*node(i), *node( bounded_rand(gen, i) ));
+
+	/* convert the successor indices into pointers, in a single
+	 * sequential pass */
+	indices_to_pointers(list, N, node_words);
+
+	return list;
+    }
+
+};
+
+/* run f(0), f(1), ..., f(threads-1) concurrently and wait for all of
+ * them to finish */
+template<class F> void run_parallel(int threads, F f) {
+    std::vector<std::thread> workers;
+
+    for(int t = 0; t < threads; t++)
+	workers.push_back(std::thread(f, t));
+
+    for(int t = 0; t < threads; t++)
+	workers[t].join();
+}
+
+template<class RNG = xoshiro256ss_rng>
+class parallel_shuffle_generator : public permutated_list_generator {
+protected:
+    int threads;
+
+    template<class F> void run_parallel(F f) { ::run_parallel(threads, f); }
+
+    int segment_begin(int t) const { return (int) ((int64_t) N * t / threads); }
+
+public:
+    static std::string name() { return "parallel_shuffle" + rng_suffix<RNG>(); }
+
+    parallel_shuffle_generator(int N,
+	    const generator_options & opts = generator_options())
+	: permutated_list_generator(N, opts), threads(opts.threads) {
+	if(threads < 1)
+	    threads = 1;
+    }
+
+    uint64_t * getlist() {
+
+	/* Parallel variant of the traversal_order shuffle: every worker
+	 * scatters the indices of its segment into randomly selected
+	 * buckets (one bucket per worker), each worker then shuffles one
+	 * bucket, and the concatenated buckets form a uniformly random
+	 * traversal order. Finally, the workers stitch the traversal
+	 * order into a single cycle, segment by segment. */
+	int B = threads;
+	uint32_t * traversal_order = scratch_array<uint32_t>(0, N);
+	std::vector<int64_t> count(threads * B, 0);
+	std::vector<int> bucket_begin(B + 1);
+
+	/* 1. assign each index to a bucket; the nodes serve as scratch
+	 *    space for the bucket numbers and are overwritten in step 4 */
+	run_parallel([&](int t) {
+	    RNG gen(derive_seed(opts.seed, t));
+
+	    for(int i = segment_begin(t); i < segment_begin(t + 1); i++) {
+		int b = (int) bounded_rand(gen, B);
+		*node(i) = b;
+		count[t * B + b] ++;
+	    }
+	});
+
+	/* turn the per-worker counts into scatter offsets; within each
+	 * bucket, worker t writes after all workers t' < t */
+	int64_t offset = 0;
+	for(int b = 0; b < B; b++) {
+	    bucket_begin[b] = (int) offset;
+	    for(int t = 0; t < threads; t++) {
+		int64_t c = count[t * B + b];
+		count[t * B + b] = offset;
+		offset += c;
+	    }
+	}
+	bucket_begin[B] = N;
+
+	/* 2. scatter the indices into their buckets */
+	run_parallel([&](int t) {
+	    for(int i = segment_begin(t); i < segment_begin(t + 1); i++)
+		traversal_order[ count[t * B + *node(i)] ++ ] = i;
+	});
+
+	/* 3. shuffle each bucket */
+	run_parallel([&](int t) {
+	    RNG gen(derive_seed(opts.seed, threads + t));
+
+	    rng_shuffle(traversal_order + bucket_begin[t],
+		traversal_order + bucket_begin[t + 1], gen);
+	});
+
+	/* 4. implement the traversal order within the pointer array; the
+	 *    last element of each segment links to the first element of
+	 *    the next one, and the last segment wraps around to the
+	 *    beginning, so we get one cycle covering all nodes */
+	run_parallel([&](int t) {
+	    int begin = segment_begin(t), end = segment_begin(t + 1);
+
+	    if(end < N) {
+		link_order(list, traversal_order + begin, end - begin,
+		    node_words);
+	    } else if(end > begin) {
+		link_order(list, traversal_order + begin, end - begin - 1,
+		    node_words);
+		*node( traversal_order[N - 1] ) =
+		    (uint64_t) node( traversal_order[0] );
+	    }
+	});
+
+	return list;
+    }
+
+};
+
+/* The cycle perm(0), perm(1), ..., perm(N-1) for a keyed bijection perm
+ * (see feistel.h), so the successor of node i is perm(perm^-1(i) + 1).
+ * Each node is computed on its own, which lets fill() build any slice
+ * of the list independently, without scratch memory; getlist() fills
+ * one slice per thread, writing sequentially. The chain only depends
+ * on N and the seed, not on the number of threads or the host. */
+class feistel_generator : public permutated_list_generator {
+protected:
+    feistel_permutation perm;
+    int threads;
+
+public:
+    static std::string name() { return "feistel"; }
+
+    feistel_generator(int N,
+	    const generator_options & opts = generator_options())
+	: permutated_list_generator(N, opts), perm(N, opts.seed),
+	  threads(std::max(opts.threads, 1)) { }
+
+    /* link the nodes in [begin; end) to their successors */
+    void fill(int begin, int end) {
+	for(int i = begin; i < end; i++) {
+	    uint64_t k = perm.inverse(i) + 1;
+	    *node(i) = (uint64_t) node( (int) perm(k < (uint64_t) N ? k : 0) );
+	}
+    }
+
+    uint64_t * getlist() {
+
+	/* the seed may have changed since construction */
+	perm = feistel_permutation(N, opts.seed);
+
+	run_parallel(threads, [&](int t) {
+	    fill((int) ((int64_t) N * t / threads),
+		(int) ((int64_t) N * (t + 1) / threads));
+	});
+
+	return list;
+    }
+
+};
+
+/* Cache-friendly variant of external_shuffle_generator: it builds the
+ * same kind of uniformly random cycle, but neither the shuffle nor the
+ * materialization of the pointers accesses memory at random across the
+ * whole list.
+ *  1. Scatter the indices into cache-sized buckets at random (writing to
+ *     a limited number of sequential streams) and shuffle each bucket
+ *     in cache, which yields a uniformly random traversal order.
+ *  2. Sort the pointer writes (node, successor) by the cache-sized
+ *     region of the list they go to, and then perform them region by
+ *     region.
+ * Costs 12 bytes of scratch memory per node, instead of 4. */
+template<class RNG = xoshiro256ss_rng>
+class blocked_shuffle_generator : public permutated_list_generator {
+protected:
+    static const int64_t BLOCK_BYTES = 256 << 10; /* fits in L2 */
+    static const int64_t MAX_STREAMS = 1024; /* concurrent write streams */
+
+    /* elements per block, such that there are at most MAX_STREAMS */
+    int block_size(int64_t element_bytes) const {
+	int64_t size = std::max<int64_t>(BLOCK_BYTES / element_bytes,
+	    (N + MAX_STREAMS - 1) / MAX_STREAMS);
+
+	return (int) std::min<int64_t>(size, N);
+    }
+
+public:
+    static std::string name() { return "blocked_shuffle" + rng_suffix<RNG>(); }
+
+    blocked_shuffle_generator(int N,
+	    const generator_options & opts = generator_options())
+	: permutated_list_generator(N, opts) { }
+
+    uint64_t * getlist() {
+
+	RNG gen(opts.seed);
+	uint32_t * traversal_order = scratch_array<uint32_t>(0, N);
+
+	/* 1. random buckets; we draw the bucket numbers twice from the
+	 *    same RNG sequence, once to count and once to scatter, rather
+	 *    than storing them */
+	int bucket_size = block_size(sizeof(uint32_t));
+	int B = (N + bucket_size - 1) / bucket_size;
+	std::vector<int64_t> offset(B + 1, 0);
+
+	RNG replay = gen;
+	for(int i = 0; i < N; i++)
+	    offset[ bounded_rand(replay, B) + 1 ] ++;
+	for(int b = 0; b < B; b++)
+	    offset[b + 1] += offset[b];
+
+	std::vector<int64_t> next(offset.begin(), offset.end() - 1);
+	for(int i = 0; i < N; i++)
+	    traversal_order[ next[ bounded_rand(gen, B) ] ++ ] = i;
+
+	for(int b = 0; b < B; b++)
+	    rng_shuffle(traversal_order + offset[b],
+		traversal_order + offset[b + 1], gen);
+
+	/* 2. pointer writes, sorted by region of the list */
+	int region_size = block_size(opts.node_bytes);
+	int R = (N + region_size - 1) / region_size;
+	std::vector<int64_t> region_offset(R + 1, 0);
+
+	for(int i = 0; i < N; i++)
+	    region_offset[ traversal_order[i] / region_size + 1 ] ++;
+	for(int r = 0; r < R; r++)
+	    region_offset[r + 1] += region_offset[r];
+
+	/* (node << 32) | successor */
+	uint64_t * writes = scratch_array<uint64_t>(1, N);
+	std::vector<int64_t> region_next(region_offset.begin(),
+	    region_offset.end() - 1);
+
 	for(int i = 0; i < N; i++) {
-	    /* std::cout << traversal_order[i] << " -> ";
-	    std::cout << traversal_order[i+1] << std::endl; */
-	    list[ traversal_order[i] ] =
-		(uint64_t) &list[ traversal_order[i+1] ];
+	    uint32_t from = traversal_order[i];
+	    uint32_t to = traversal_order[ (i + 1 < N) ? i + 1 : 0 ];
+
+	    writes[ region_next[ from / region_size ] ++ ] =
+		((uint64_t) from << 32) | to;
 	}
 
-	delete traversal_order;
+	for(int i = 0; i < N; i++)
+	    *node( (int) (writes[i] >> 32) ) =
+		(uint64_t) node( (int) (uint32_t) writes[i] );
 
 	return list;
     }
 
 };
 
-template<class T> float testGenerator(int N, bool printHist) {
+/* Chase through all nodes of a window of pages, in random order, before
+ * moving on to the next window, and visit the windows in random order as
+ * well. The chain thus misses the TLB at most once per window's worth of
+ * page entries, largely independent of the working set size, while
+ * still forming a single cycle over all nodes. The windows are aligned
+ * relative to the start of the list. */
+template<class RNG = xoshiro256ss_rng>
+class page_window_generator : public permutated_list_generator {
 
-    T gen(N);
-    int * strides = new int[2*N];
-    int i;
+public:
+    static std::string name() { return "page_window" + rng_suffix<RNG>(); }
 
-    for(i = 0; i < 2 * N; i++)
-	strides[i] = 0;
+    page_window_generator(int N,
+	    const generator_options & opts = generator_options())
+	: permutated_list_generator(N, opts) { }
 
-    std::cout << typeid(T).name() << ": list of " << N << " elements." << std::endl;
+    uint64_t * getlist() {
 
-    uint64_t * list = gen.getlist();
-    uint64_t * p = list;
+	int64_t window_bytes = opts.page_bytes * std::max(opts.window_pages, 1);
+	int M = (int) std::min<int64_t>(std::max<int64_t>(
+	    window_bytes / opts.node_bytes, 1), N); /* nodes per window */
+	int W = (N + M - 1) / M;
 
-    int cyclelength = 0;
-    bool * visited = new bool[N];
+	RNG gen(opts.seed);
 
-    for(i = 0; i < N; i++)
-	visited[i] = false;
+	int * window_order = scratch_array<int>(0, W);
+	for(int w = 0; w < W; w++)
+	    window_order[w] = w;
+	rng_shuffle(window_order, window_order + W, gen);
 
-    do {
-	/* std::cout << " " << (p - list) << ","; */
+	/* traversal order within the current window */
+	uint32_t * traversal_order = scratch_array<uint32_t>(1, M);
 
-	visited[ p - list ] = true;
+	uint64_t * entry = NULL;
+	uint64_t * tail = NULL;
 
-	cyclelength ++;
+	for(int w = 0; w < W; w++) {
+	    int base = window_order[w] * M;
+	    int m = std::min(M, N - base);
 
-	int stride = (int) ( ((uint64_t *) *p) - p);
+	    iota_u32(traversal_order, m, base);
+	    rng_shuffle(traversal_order, traversal_order + m, gen);
 
-	/* Note: when coding undercaffeinated, you might need to resort
-	 * to this kind of debugging:
-	 std::cout << (p - list) << " -> " << ( (uint64_t *)*p - list)
-		<< ": " << stride << " idx " << (N + stride) << std::endl;
-	 */
+	    /* link the previous window's last node to this window */
+	    if(tail)
+		*tail = (uint64_t) node( traversal_order[0] );
+	    else
+		entry = node( traversal_order[0] );
 
-	strides[ N + stride ] ++;
+	    link_order(list, traversal_order, m - 1, node_words);
 
-	p = (uint64_t *) *p;
+	    tail = node( traversal_order[m-1] );
+	}
 
-    } while( ! visited[ p - list ] );
+	/* and back to the beginning */
+	*tail = (uint64_t) entry;
 
-    std::cout << typeid(T).name() << ": found cycle of length " << cyclelength;
-    float covered = (100.0* cyclelength) / N;
-    std::cout << " (i.e., covering " << covered << "%)";
-    std::cout << " on index " << (p - list) << std::endl;
+	return list;
+    }
 
-    std::cout << std::endl;
+};
 
-    if(printHist) {
-	/* simple early version
-	    std::cout << "Histogram of stride lengths" << std::endl;
-	for(i = 0; i < 2 * N; i++) {
-	    int stride = i - N;
-	
-	    std::cout << stride << " | " << strides[i] << std::endl;
+/* A single cycle that gives the hardware prefetchers nothing to go on:
+ * no hop is shorter than opts.min_stride_lines cache lines or
+ * opts.min_stride_pages pages, which keeps it out of reach of the
+ * adjacent-line prefetcher and of the stream prefetchers (which stay
+ * within a page), and no two successive hops have the same stride,
+ * which leaves the stride prefetcher without a pattern.
+ *
+ * We shuffle a random cycle, as external_shuffle_generator does, and
+ * repair it in one pass: where the hop from position i breaks a rule,
+ * we swap its target with the node at a random position j if that
+ * leaves the hops around both positions within the rules. Swapping two
+ * positions of the traversal order keeps it a single cycle. The minimum
+ * stride is capped at N / 8 nodes, so that most candidates fit; chains
+ * of a handful of nodes may still break a rule after MAX_ATTEMPTS
+ * candidates (all cycles over 3 nodes repeat a stride), which getlist()
+ * warns about. The strides are thus not quite uniformly distributed,
+ * noticeably so once the minimum stride is a sizeable part of N. */
+template<class RNG = xoshiro256ss_rng>
+class adversarial_generator : public permutated_list_generator {
+protected:
+    static const int MAX_ATTEMPTS = 256;
+
+    uint32_t * order; /* the traversal order, cyclic */
+    int64_t min_stride; /* in nodes */
+
+    /* position p modulo N, for -N <= p < 2N */
+    int wrap(int64_t p) const {
+	return (int) (p < 0 ? p + N : (p >= N ? p - N : p));
+    }
+
+    /* of the hop from position p to p + 1 */
+    int64_t stride(int64_t p) const {
+	return (int64_t) order[wrap(p + 1)] - order[wrap(p)];
+    }
+
+    bool long_enough(int64_t p) const {
+	int64_t s = stride(p);
+
+	return s >= min_stride || s <= -min_stride;
+    }
+
+    /* whether the hop from position p keeps the rules */
+    bool hop_valid(int64_t p) const {
+	return long_enough(p) && stride(p) != stride(p - 1);
+    }
+
+    /* whether the rules that involve the node at position p hold */
+    bool valid_around(int64_t p) const {
+	return hop_valid(p - 1) && hop_valid(p) && stride(p + 1) != stride(p);
+    }
+
+public:
+    static std::string name() { return "adversarial" + rng_suffix<RNG>(); }
+
+    adversarial_generator(int N,
+	    const generator_options & opts = generator_options())
+	: permutated_list_generator(N, opts), order(NULL), min_stride(1) { }
+
+    uint64_t * getlist() {
+
+	int64_t min_bytes = std::max<int64_t>(
+	    (int64_t) opts.min_stride_lines * cacheline_size(),
+	    (int64_t) opts.min_stride_pages * opts.page_bytes);
+	min_stride = std::max<int64_t>(std::min<int64_t>(
+	    (min_bytes + opts.node_bytes - 1) / opts.node_bytes, N / 8), 1);
+
+	order = scratch_array<uint32_t>(0, N + 1);
+	iota_u32(order, N, 0);
+
+	RNG gen(opts.seed);
+	rng_shuffle(order, order + N, gen);
+
+	int unresolved = 0;
+
+	for(int i = 0; i < N; i++) {
+	    if(hop_valid(i))
+		continue;
+
+	    /* the node we hop to from position i */
+	    int q = wrap(i + 1);
+	    bool repaired = false;
+
+	    for(int attempt = 0; attempt < MAX_ATTEMPTS && !repaired; attempt++) {
+		int j = (int) bounded_rand(gen, N);
+		if(j == q)
+		    continue;
+
+		std::swap(order[q], order[j]);
+		repaired = valid_around(q) && valid_around(j);
+		if(!repaired)
+		    std::swap(order[q], order[j]);
+	    }
+
+	    if(!repaired)
+		unresolved ++;
+	}
+
+	if(unresolved)
+	    std::cerr << "warning: " << name() << ": " << unresolved <<
+		" of " << N << " hops break the stride rules" << std::endl;
+
+	/* and back to the beginning */
+	order[N] = order[0];
+	link_order(list, order, N, node_words);
+
+	return list;
+    }
+
+};
+
+/* Sattolo's algorithm, for chains of indices (see chase.h) instead of
+ * pointers: each node is an entry of type I (or node_bytes / sizeof(I)
+ * of them, the first of which is used), holding the position of its
+ * successor, relative to the list or, with relative = true, to the node
+ * itself. The chain starts at entry 0. For the same seed, the cycle is
+ * the one sattolo_generator<RNG> builds. */
+template<class I, bool relative = false, class RNG = xoshiro256ss_rng>
+class sattolo_index_generator {
+protected:
+    int N;
+    I * list;
+    generator_options opts;
+    int node_entries; /* entries of I per node */
+
+    I & node(int i) { return list[(int64_t) i * node_entries]; }
+
+public:
+    sattolo_index_generator(int N,
+	    const generator_options & opts = generator_options())
+	: N(N), opts(opts) {
+	node_entries = std::max<int>(opts.node_bytes / sizeof(I), 1);
+	this->opts.node_bytes = node_entries * sizeof(I);
+
+	if((uint64_t) N * node_entries - 1 > (uint64_t) std::numeric_limits<I>::max()) {
+	    std::cerr << "cannot index " << N << " nodes of "
+		<< this->opts.node_bytes << " bytes with " << 8 * sizeof(I)
+		<< " bits" << std::endl;
+	    exit(EXIT_FAILURE);
 	}
-	*/
 
-	/* tidy histogram on 20 lines */
-	int hist[20], a[20], b[20];
-	int maxAmount = 0;
+	list = (I *) opts.alloc.allocate(list_bytes());
+    }
+
+    ~sattolo_index_generator() {
+	opts.alloc.release(list, list_bytes());
+    }
+
+    size_t list_bytes() const { return (size_t) N * node_entries * sizeof(I); }
+
+    int getN() const { return N; }
+    int getNodeBytes() const { return opts.node_bytes; }
+
+    typedef I index_type;
+    static const bool relative_offsets = relative;
+
+    static std::string name() {
+	return std::string(relative ? "sattolo_offset" : "sattolo_index") +
+	    std::to_string(8 * sizeof(I)) + rng_suffix<RNG>();
+    }
+
+    I * getlist() {
 
-	std::cout << "Histogram of stride lengths" << std::endl;
-	for(i = 0; i < 20; i++) {
-	    a[i] = (int) (-N + (2.0*N / 20) * i);
-	    b[i] = (int) (-N + (2.0*N / 20) * (i+1));
+	for(int i = 0; i < N; i++)
+	    node(i) = i;
 
-	    hist[i]= 0;
+	RNG gen(opts.seed);
 
-	    for(int j = a[i] + N; j < b[i] + N; j++)
-		hist[i] += strides[j];
+	for(int i = N - 1; i > 0; i--)
+	    std::swap(node(i), node( bounded_rand(gen, i) ));
 
-	    if(hist[i] > maxAmount)
-		maxAmount = hist[i];
+	/* successor indices to positions in entries, in a single
+	 * sequential pass; unsigned wrap-around makes the relative
+	 * offsets of backward strides work */
+	for(int i = 0; i < N; i++) {
+	    I next = node(i) * (I) node_entries;
+	    node(i) = relative ? (I) (next - (I) i * node_entries) : next;
 	}
 
-	for(i = 0; i < 20; i++) {
-	    std::cout <<  "[" << std::setw(9) << a[i] << ";";
-	    std::cout << std::setw(9) << b[i] << ") ";
+	return list;
+    }
+
+};
+
+/* A uniformly random cycle that can grow node by node: inserting node k
+ * after one of the nodes 0, ..., k-1, drawn uniformly, turns a uniformly
+ * random cycle over k nodes into one over k+1 nodes (each cycle over k+1
+ * nodes arises from exactly one cycle over k nodes and insertion point).
+ * grow(n) extends the cycle over the first nodes of the list to the
+ * first n nodes, at the cost of one random access per new node, so a
+ * sweep over growing working sets costs as much as its largest chain.
+ * getlist() builds the cycle over all N nodes from scratch. The chain
+ * starts at node 0. */
+template<class RNG = xoshiro256ss_rng>
+class growing_generator : public permutated_list_generator {
+protected:
+    RNG gen;
+    int size; /* nodes in the cycle so far */
+
+public:
+    static const bool growable = true;
+
+    static std::string name() { return "growing" + rng_suffix<RNG>(); }
 
-	    int dots = 40 * hist[i] / maxAmount;
+    growing_generator(int N,
+	    const generator_options & opts = generator_options())
+	: permutated_list_generator(N, opts), gen(opts.seed), size(0) { }
 
-	    for(int j = 0; j < dots; j++)
-		std::cout << '*';
+    int getSize() const { return size; }
 
-	    for(int j = 0; j < 40 - dots; j++)
-		std::cout << ' ';
+    /* grow the cycle to min(n, N) nodes; never shrinks it */
+    uint64_t * grow(int n) {
+	n = std::min(n, N);
 
-	    std::cout << " (" << hist[i] << ")" << std::endl;
+	if(size == 0 && n > 0) {
+	    *node(0) = (uint64_t) node(0);
+	    size = 1;
 	}
 
-	std::cout << std::endl;
+	for(int k = size; k < n; k++) {
+	    uint64_t * after = node( bounded_rand(gen, k) );
+	    *node(k) = *after;
+	    *after = (uint64_t) node(k);
+	}
+
+	size = std::max(size, n);
+
+	return list;
     }
 
-    delete strides;
-    delete visited;
+    uint64_t * getlist() {
+	gen = RNG(opts.seed);
+	size = 0;
 
-    return covered;
-}
+	return grow(N);
+    }
 
-template<class T> void speedrun(int N) {
+};
 
-    T gen(N);
+/* Number of distinct pages touched per block of K consecutive hops,
+ * averaged over all blocks, as an estimate of the TLB pressure of a
+ * chain. */
+class page_counter {
+    int K;
+    int shift; /* log2 of the page size */
+    std::vector<uint64_t> pages;
+    int64_t blocks;
+    int64_t distinct;
 
-    uint64_t * l = gen.getlist();
+public:
+    page_counter(int K, int64_t page_bytes)
+	: K(K), shift(0), blocks(0), distinct(0) {
+	while(((int64_t) 1 << shift) < page_bytes)
+	    shift++;
+	pages.reserve(K);
+    }
 
-    (void) l;
+    void add(const void * address) {
+	pages.push_back((uint64_t) address >> shift);
 
-}
+	if((int) pages.size() == K) {
+	    std::sort(pages.begin(), pages.end());
+	    distinct += std::unique(pages.begin(), pages.end()) - pages.begin();
+	    blocks ++;
+	    pages.clear();
+	}
+    }
 
-int main(int argc, char ** argv) {
+    /* partial blocks at the end of the chain are not accounted */
+    double average() const {
+	return blocks ? (double) distinct / blocks : 0;
+    }
+};
 
-    //testGenerator<external_shuffle_generator>(32<<20, true);
-    //speedrun<XMem_list_generator>(32 << 20);
-    //speedrun<external_shuffle_generator>(32 << 20);
+/* Where the chain starting at head runs into a cycle: it has a tail of mu
+ * nodes and then a cycle of lambda nodes. Brent's algorithm finds both
+ * without any per-node memory, in at most three walks along the chain;
+ * the caller must make sure that every node on the way is valid. */
+struct cycle_info {
+    int64_t mu;
+    int64_t lambda;
+};
 
-    testGenerator<external_shuffle_generator>(128, true);
-    testGenerator<external_shuffle_generator>(1024, true);
-    testGenerator<external_shuffle_generator>(6<<20, true);
-    testGenerator<external_shuffle_generator>(32<<20, true);
+cycle_info find_cycle(uint64_t * head) {
+    cycle_info c;
+    int64_t power = 1;
 
-    testGenerator<XMem_list_generator>(128, true);
-    testGenerator<XMem_list_generator>(1024, true);
+    c.lambda = 1;
 
+    uint64_t * tortoise = head;
+    uint64_t * hare = (uint64_t *) *head;
 
-    testGenerator<XMem_list_generator>(6 << 20, true);
-    testGenerator<XMem_list_generator>(32 << 20, true);
-    /* testGenerator(6<<20, true); */
-    /* testGenerator(20<<20, true);
-    testGenerator(32<<20, true);
-    testGenerator(64<<20, true); */
-    /* testGenerator(128<<20, true); */
-    /* testGenerator(256<<20, true); */
+    while(tortoise != hare) {
+	if(power == c.lambda) {
+	    tortoise = hare;
+	    power *= 2;
+	    c.lambda = 0;
+	}
+	hare = (uint64_t *) *hare;
+	c.lambda ++;
+    }
 
-    float sum = 0;
-    for(int i = 0; i < 100; i++)
-	sum += testGenerator<XMem_list_generator>(2 << 20, false);
+    /* the hare moves lambda nodes ahead, then both advance until they
+     * meet at the first node of the cycle */
+    tortoise = hare = head;
+    for(int64_t i = 0; i < c.lambda; i++)
+	hare = (uint64_t *) *hare;
 
-    sum /= 100;
+    for(c.mu = 0; tortoise != hare; c.mu++) {
+	tortoise = (uint64_t *) *tortoise;
+	hare = (uint64_t *) *hare;
+    }
 
-    float sum2 = 0;
-    for(int i = 0; i < 100; i++)
-	sum2 += testGenerator<external_shuffle_generator>(2 << 20, false);
+    return c;
+}
 
-    sum2 /= 100;
+/* the chain of gen, for the drivers that cannot do without one; these
+ * end the program if the generator does not support its options */
+template<class T> uint64_t * require_list(T & gen) {
+    uint64_t * head = gen.getlist();
 
-    std::cout << std::endl << "X-Mem: for 2 MiB test case, average coverage of ";
-    std::cout << sum << "% (100 runs)" << std::endl;
+    if(!head) {
+	std::cerr << T::name() << ": cannot build a chain of " << gen.getN();
+	std::cerr << " nodes of " << gen.getNodeBytes() << " bytes" << std::endl;
+	exit(EXIT_FAILURE);
+    }
 
-    std::cout << std::endl << "external shuffle: for 2 MiB test case, average coverage of ";
-    std::cout << sum2 << "% (100 runs)" << std::endl;
+    return head;
+}
+
+/* testGenerator() for nodes of W words, or of any size for W = 0; with W
+ * known at compile time, the divisions by the node size in the walk
+ * become shifts */
+template<class T, int W> float testChain(T & gen, int N, bool printHist,
+	int bins, histogram_scale_t scale) {
+
+    int node_bytes = gen.getNodeBytes();
+    const int words = W ? W : node_bytes / 8;
+
+    std::cout << T::name() << ": list of " << N << " elements";
+    std::cout << " of " << node_bytes << " bytes." << std::endl;
+
+    phase_meter meter;
+
+    meter.start();
+    uint64_t * list = gen.getlist();
+    phase_usage generation = meter.stop();
+
+    if(!list) {
+	std::cout << T::name() << ": unsupported with these options, skipped";
+	std::cout << std::endl << std::endl;
+	return 0;
+    }
+
+    uint64_t * end = list + (int64_t) N * words;
+
+    /* tidy histogram, by default on 20 lines; we bin during the walk, so
+     * that we need no memory proportional to N */
+    stride_histogram hist(N, bins, scale);
+    stride_tests tests(N, node_bytes);
+
+    const int K = 64;
+    page_counter pages_4KiB(K, PAGE_4KiB), pages_2MiB(K, PAGE_2MiB);
+
+    /* strides are binned in batches */
+    const int BATCH = 256;
+    int64_t strides[BATCH];
+    int batched = 0;
+
+    auto flush = [&]() {
+	hist.add_batch(strides, batched);
+	tests.add_batch(strides, batched);
+	batched = 0;
+    };
+
+    auto reset = [&]() {
+	batched = 0;
+	hist.reset();
+	tests.reset();
+	pages_4KiB = page_counter(K, PAGE_4KiB);
+	pages_2MiB = page_counter(K, PAGE_2MiB);
+    };
+
+    auto account = [&](uint64_t * p, uint64_t * next) {
+	/* in nodes, not in words */
+	int stride = (int) ( (next - p) / words );
+
+	/* Note: when coding undercaffeinated, you might need to resort
+	 * to this kind of debugging:
+	 std::cout << (p - list) / words << " -> " << (next - list) / words
+		<< ": " << stride << std::endl;
+	 */
+
+	strides[batched++] = stride;
+	if(batched == BATCH)
+	    flush();
+
+	if(printHist) {
+	    pages_4KiB.add(p);
+	    pages_2MiB.add(p);
+	}
+    };
+
+    reset();
+    meter.start();
+
+    /* Usually, the chain is a cycle through the head, and we are back at
+     * the head after at most N hops. On the way, make sure that the
+     * chain does not leave the list. */
+    int64_t cyclelength = 0;
+    uint64_t * p = list;
+
+    do {
+	uint64_t * next = (uint64_t *) *p;
+
+	if(next < list || next >= end || (next - list) % words) {
+	    std::cout << T::name() << ": chain leaves the list at index ";
+	    std::cout << (p - list) / words << std::endl << std::endl;
+	    return 0;
+	}
+
+	account(p, next);
+	cyclelength ++;
+	p = next;
+
+    } while(p != list && cyclelength < N);
+
+    /* Otherwise, the head is on a tail leading into a cycle elsewhere;
+     * all nodes on the way are valid, as we have just checked. Count
+     * (and bin) every node we visit once, as before. */
+    if(p != list) {
+	cycle_info c = find_cycle(list);
+
+	reset();
+	cyclelength = c.mu + c.lambda;
+
+	p = list;
+	for(int64_t j = 0; j < cyclelength; j++) {
+	    uint64_t * next = (uint64_t *) *p;
+	    account(p, next);
+	    p = next;
+	}
+    }
+
+    flush();
+    phase_usage walk = meter.stop();
+
+    std::cout << T::name() << ": found cycle of length " << cyclelength;
+    float covered = (100.0* cyclelength) / N;
+    std::cout << " (i.e., covering " << covered << "%)";
+    std::cout << " on index " << ((p - list) / words) << std::endl;
+
+    /* what it takes to build the chain, besides the list itself */
+    std::cout << T::name() << ": getlist: " << generation << "; walk: ";
+    std::cout << walk << "; " << gen.scratch_bytes();
+    std::cout << " bytes of scratch memory mapped" << std::endl;
+
+    std::cout << std::endl;
+
+    if(printHist) {
+	std::cout << "Histogram of stride lengths in nodes [and bytes]" << std::endl;
+	hist.print(std::cout, node_bytes);
+
+	std::cout << "Distinct pages per " << K << " hops: ";
+	std::cout << pages_4KiB.average() << " (4 KiB), ";
+	std::cout << pages_2MiB.average() << " (2 MiB)" << std::endl;
+
+	tests.print(std::cout, node_bytes);
+	std::cout << T::name() << ": randomness tests ";
+	std::cout << (tests.passed() ? "passed" : "FAILED") << std::endl;
+
+	std::cout << std::endl;
+    }
+
+    return covered;
+}
+
+/* test gen again, rebuilding its chain with the given seed in the memory
+ * of the previous run */
+template<class T> float testGenerator(T & gen, uint64_t seed, bool printHist,
+	int bins = 20, histogram_scale_t scale = HIST_LINEAR) {
+
+    int N = gen.getN();
+
+    gen.reseed(seed);
+
+    switch(gen.getNodeBytes()) {
+    case NODE_64b: return testChain<T, 1>(gen, N, printHist, bins, scale);
+    case NODE_128b: return testChain<T, 2>(gen, N, printHist, bins, scale);
+    case NODE_256b: return testChain<T, 4>(gen, N, printHist, bins, scale);
+    case NODE_512b: return testChain<T, 8>(gen, N, printHist, bins, scale);
+    default: return testChain<T, 0>(gen, N, printHist, bins, scale);
+    }
+}
+
+template<class T> float testGenerator(int N, bool printHist,
+	const generator_options & opts = generator_options(),
+	int bins = 20, histogram_scale_t scale = HIST_LINEAR) {
+
+    T gen(N, opts);
+
+    return testGenerator(gen, opts.seed, printHist, bins, scale);
+}
+
+template<class T> double timeGenerator(int N,
+	const generator_options & opts = generator_options()) {
+
+    T gen(N, opts);
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t * l = require_list(gen);
+    auto end = std::chrono::steady_clock::now();
+
+    (void) l;
+
+    return std::chrono::duration<double>(end - start).count();
+}
+
+void speedrunHeader() {
+    std::cout << std::setw(48) << "generator" << std::setw(12) << "N";
+    std::cout << std::setw(12) << "time [s]";
+    std::cout << std::setw(12) << "ref. [s]";
+    std::cout << std::setw(10) << "speedup" << std::endl;
+}
+
+/* time T against external_shuffle_generator as the reference and print
+ * one row of the speedup table (see speedrunHeader()) */
+template<class T> void speedrun(int N,
+	const generator_options & opts = generator_options()) {
+
+    double t = timeGenerator<T>(N, opts);
+    double ref = timeGenerator< external_shuffle_generator<> >(N, opts);
+
+    std::cout << std::setw(48) << T::name() << std::setw(12) << N;
+    std::cout << std::setw(12) << t << std::setw(12) << ref;
+    std::cout << std::setw(9) << (ref / t) << "x" << std::endl;
+}
+
+void latencyHeader() {
+    std::cout << std::setw(48) << "generator" << std::setw(12) << "N";
+    std::cout << std::setw(14) << "bytes";
+    std::cout << std::setw(10) << "ns/hop";
+    std::cout << std::setw(12) << "ticks/hop" << std::endl;
+}
+
+/* Chase the chain built by T and print one row of the latency table (see
+ * latencyHeader()). We chase for at least N hops, so that every node of
+ * a single cycle is visited, and at least min_hops, so that short chains
+ * are timed accurately; a full pass beforehand warms up caches and TLB.
+ * Generators that produce several cycles only exercise the part of the
+ * working set reachable from the head, which shows in the result. */
+template<class T> chase_result measureLatency(int N,
+	const generator_options & opts = generator_options(),
+	int64_t min_hops = 1 << 24) {
+
+    T gen(N, opts);
+    uint64_t * head = require_list(gen);
+
+    chase_result r = timed_chase(head, std::max<int64_t>(N, min_hops), N);
+
+    std::cout << std::setw(48) << T::name() << std::setw(12) << N;
+    std::cout << std::setw(14) << gen.list_bytes();
+    std::cout << std::setw(10) << r.ns_per_hop;
+    std::cout << std::setw(12) << r.ticks_per_hop << std::endl;
+
+    return r;
+}
+
+/* Follow the index chain built by T from entry 0 and report the length
+ * of the cycle through it, as testGenerator() does for pointer chains. */
+template<class T> float testIndexGenerator(int N,
+	const generator_options & opts = generator_options()) {
+
+    typedef typename T::index_type I;
+
+    T gen(N, opts);
+    I * list = gen.getlist();
+    int64_t entries = (int64_t) gen.list_bytes() / sizeof(I);
+    int64_t step = gen.getNodeBytes() / sizeof(I);
+
+    std::cout << T::name() << ": index list of " << N << " elements";
+    std::cout << " of " << gen.getNodeBytes() << " bytes." << std::endl;
+
+    int64_t cyclelength = 0;
+    int64_t i = 0;
+
+    do {
+	int64_t next = T::relative_offsets ?
+	    (int64_t) (I) (list[i] + (I) i) : (int64_t) list[i];
+
+	if(next < 0 || next >= entries || next % step) {
+	    std::cout << T::name() << ": chain leaves the list at index ";
+	    std::cout << i / step << std::endl << std::endl;
+	    return 0;
+	}
+
+	cyclelength ++;
+	i = next;
+    } while(i != 0 && cyclelength < N);
+
+    float covered = (100.0 * cyclelength) / N;
+    std::cout << T::name() << ": found cycle of length " << cyclelength;
+    std::cout << " (i.e., covering " << covered << "%)";
+    std::cout << " on index " << i / step << std::endl << std::endl;
+
+    return covered;
+}
+
+/* as measureLatency(), for the index chains of T */
+template<class T> chase_result measureIndexLatency(int N,
+	const generator_options & opts = generator_options(),
+	int64_t min_hops = 1 << 24) {
+
+    T gen(N, opts);
+
+    chase_result r = timed_index_chase(gen.getlist(), T::relative_offsets,
+	std::max<int64_t>(N, min_hops), N);
+
+    std::cout << std::setw(48) << T::name() << std::setw(12) << N;
+    std::cout << std::setw(14) << gen.list_bytes();
+    std::cout << std::setw(10) << r.ns_per_hop;
+    std::cout << std::setw(12) << r.ticks_per_hop << std::endl;
+
+    return r;
+}
+
+/* Working-set sweep
+ * =================
+ *
+ * Build a chain of each working-set size from min_bytes up to max_bytes,
+ * growing geometrically by step, chase it, and write one CSV line per
+ * size:
+ *   generator,node_bytes,bytes,N,generation_s,ns_per_hop,ticks_per_hop
+ */
+struct sweep_options {
+    int64_t min_bytes;
+    int64_t max_bytes;
+    double step;
+    generator_options gen;
+
+    sweep_options() : min_bytes(l1_size()), max_bytes(4LL << 30), step(2) { }
+
+    static int64_t l1_size() {
+	long size = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+
+	return (size > 0) ? size : 32 << 10;
+    }
+};
+
+/* one measurement: build a chain of N nodes with T, time that, and time
+ * a chase of max(N, min_hops) hops over it after one pass of warm-up */
+struct run_sample {
+    size_t bytes;
+    int node_bytes;
+    double generation_s;
+    chase_result chase;
+};
+
+/* take one sample per repetition, with seeds opts.seed, opts.seed + 1,
+ * ...; all repetitions reuse one generator, so only the first one pays
+ * for faulting in the list and the scratch memory */
+template<class T> std::vector<run_sample> sampleGenerator(int N,
+	const generator_options & opts, int64_t min_hops, int repetitions) {
+    std::vector<run_sample> samples;
+    T gen(N, opts);
+
+    for(int r = 0; r < repetitions; r++) {
+	run_sample s;
+
+	gen.reseed(opts.seed + r);
+
+	auto start = std::chrono::steady_clock::now();
+	uint64_t * head = gen.getlist();
+	auto end = std::chrono::steady_clock::now();
+
+	/* no samples at all, if the generator does not support opts */
+	if(!head)
+	    break;
+
+	s.bytes = gen.list_bytes();
+	s.node_bytes = gen.getNodeBytes();
+	s.generation_s = std::chrono::duration<double>(end - start).count();
+	s.chase = timed_chase(head, std::max<int64_t>(N, min_hops), N);
+
+	samples.push_back(s);
+    }
+
+    return samples;
+}
+
+/* the chain sizes of a sweep, in nodes */
+std::vector<int> sweep_sizes(const sweep_options & so) {
+    std::vector<int> sizes;
+
+    for(double bytes = so.min_bytes; bytes <= so.max_bytes; bytes *= so.step) {
+	int N = (int) std::min<int64_t>((int64_t) bytes / so.gen.node_bytes,
+	    INT_MAX);
+	if(N >= 2)
+	    sizes.push_back(N);
+
+	if(so.step <= 1)
+	    break;
+    }
+
+    return sizes;
+}
+
+void sweepRow(std::ostream & csv, const std::string & name, int node_bytes,
+	int N, double generation_s, const chase_result & r) {
+    size_t bytes = (size_t) N * node_bytes;
+
+    csv << name << "," << node_bytes << "," << bytes;
+    csv << "," << N << "," << generation_s << "," << r.ns_per_hop;
+    csv << "," << r.ticks_per_hop << std::endl;
+
+    std::cerr << name << ": " << bytes << " bytes, ";
+    std::cerr << r.ns_per_hop << " ns/hop" << std::endl;
+}
+
+/* build every chain from scratch */
+template<class T> void sweep(const sweep_options & so, std::ostream & csv,
+	std::false_type) {
+
+    for(int N : sweep_sizes(so)) {
+	std::vector<run_sample> samples = sampleGenerator<T>(N, so.gen, 1 << 24, 1);
+	if(samples.empty())
+	    return;
+
+	run_sample s = samples[0];
+
+	sweepRow(csv, T::name(), s.node_bytes, N, s.generation_s, s.chase);
+    }
+}
+
+/* grow one chain from each size to the next, so that generation_s is
+ * the cost of the growth, and the whole sweep costs about as much as
+ * building the largest chain */
+template<class T> void sweep(const sweep_options & so, std::ostream & csv,
+	std::true_type) {
+
+    std::vector<int> sizes = sweep_sizes(so);
+    if(sizes.empty())
+	return;
+
+    T gen(sizes.back(), so.gen);
+
+    for(int N : sizes) {
+	auto start = std::chrono::steady_clock::now();
+	uint64_t * head = gen.grow(N);
+	auto end = std::chrono::steady_clock::now();
+
+	chase_result r = timed_chase(head, std::max<int64_t>(N, 1 << 24), N);
+
+	sweepRow(csv, T::name(), gen.getNodeBytes(), N,
+	    std::chrono::duration<double>(end - start).count(), r);
+    }
+}
+
+template<class T> void sweep(const sweep_options & so, std::ostream & csv) {
+    sweep<T>(so, csv, std::integral_constant<bool, T::growable>());
+}
+
+/* Loaded latency
+ * ==============
+ *
+ * One chasing thread per CPU in chase_cpus, each chasing its own chain,
+ * which it builds (with T) in memory on its own NUMA node. Optionally,
+ * one bandwidth hog per CPU in hog_cpus streams over a separate buffer
+ * on its node meanwhile, to load the memory system. Every chaser takes
+ * samples of hops_per_sample hops each, and we print the percentiles of
+ * ns/hop over the samples, per chaser.
+ */
+struct loaded_options {
+    std::vector<int> chase_cpus;
+    std::vector<int> hog_cpus;
+    int64_t chain_bytes;
+    int64_t hog_bytes;
+    bool hog_writes; /* read-modify-write instead of read only */
+    int samples;
+    int64_t hops_per_sample;
+    generator_options gen;
+
+    loaded_options()
+	: chain_bytes(256 << 20), hog_bytes(256 << 20), hog_writes(false),
+	  samples(1000), hops_per_sample(1 << 14) { }
+};
+
+struct chaser_result {
+    int cpu;
+    int node;
+    std::vector<double> ns_per_hop; /* per sample */
+};
+
+void bandwidthHog(int cpu, const loaded_options & lo,
+	std::atomic<int> & ready, const std::atomic<bool> & stop) {
+
+    pin_thread(cpu);
+
+    list_allocator alloc = lo.gen.alloc;
+    alloc.numa_node = current_numa_node();
+    alloc.prefault = true;
+
+    size_t words = lo.hog_bytes / 8;
+    uint64_t * buf = (uint64_t *) alloc.allocate(words * 8);
+    uint64_t sum = 0;
+
+    ready ++;
+
+    while(!stop) {
+	if(lo.hog_writes) {
+	    for(size_t i = 0; i < words; i++)
+		buf[i] ++;
+	} else {
+	    for(size_t i = 0; i < words; i++)
+		sum += buf[i];
+	}
+	g_chase_sink = (uint64_t *) sum;
+    }
+
+    alloc.release(buf, words * 8);
+}
+
+template<class T> void chaser(int cpu, const loaded_options & lo,
+	chaser_result & result, std::atomic<int> & ready, int expected) {
+
+    pin_thread(cpu);
+
+    generator_options opts = lo.gen;
+    opts.alloc.numa_node = current_numa_node();
+    opts.threads = 1; /* the other CPUs chase, too */
+
+    int N = (int) std::min<int64_t>(lo.chain_bytes / opts.node_bytes, INT_MAX);
+    T gen(N, opts);
+    uint64_t * p = chase(require_list(gen), N);
+
+    result.cpu = cpu;
+    result.node = opts.alloc.numa_node;
+
+    /* start measuring once all chains are built and all hogs run */
+    ready ++;
+    while(ready < expected)
+	std::this_thread::yield();
+
+    for(int s = 0; s < lo.samples; s++) {
+	auto start = std::chrono::steady_clock::now();
+	p = chase(p, lo.hops_per_sample);
+	auto end = std::chrono::steady_clock::now();
+
+	result.ns_per_hop.push_back(
+	    std::chrono::duration<double, std::nano>(end - start).count() /
+	    lo.hops_per_sample);
+    }
+
+    g_chase_sink = p;
+}
+
+/* the p-th percentile of sorted values, p in [0; 100] */
+double percentile(const std::vector<double> & sorted, double p) {
+    if(sorted.empty())
+	return 0;
+
+    size_t i = (size_t) (p / 100 * (sorted.size() - 1) + 0.5);
+    return sorted[i];
+}
+
+template<class T> void loadedLatency(const loaded_options & lo) {
+
+    std::vector<chaser_result> results(lo.chase_cpus.size());
+    std::vector<std::thread> chasers, hogs;
+    std::atomic<int> ready(0);
+    std::atomic<bool> stop(false);
+    int expected = (int) (lo.chase_cpus.size() + lo.hog_cpus.size());
+
+    for(int cpu : lo.hog_cpus)
+	hogs.push_back(std::thread(bandwidthHog, cpu, std::cref(lo),
+	    std::ref(ready), std::cref(stop)));
+
+    for(size_t t = 0; t < lo.chase_cpus.size(); t++)
+	chasers.push_back(std::thread(chaser<T>, lo.chase_cpus[t],
+	    std::cref(lo), std::ref(results[t]), std::ref(ready), expected));
+
+    for(std::thread & t : chasers)
+	t.join();
+
+    stop = true;
+    for(std::thread & t : hogs)
+	t.join();
+
+    std::cout << T::name() << ": " << lo.chase_cpus.size() << " chasers with ";
+    std::cout << lo.chain_bytes << " bytes each, " << lo.hog_cpus.size();
+    std::cout << " bandwidth hogs" << std::endl;
+
+    std::cout << std::setw(6) << "cpu" << std::setw(6) << "node";
+    std::cout << std::setw(10) << "min" << std::setw(10) << "p50";
+    std::cout << std::setw(10) << "p90" << std::setw(10) << "p99";
+    std::cout << std::setw(10) << "max" << "  (ns/hop)" << std::endl;
+
+    for(chaser_result & r : results) {
+	std::sort(r.ns_per_hop.begin(), r.ns_per_hop.end());
+
+	std::cout << std::setw(6) << r.cpu << std::setw(6) << r.node;
+	std::cout << std::setw(10) << percentile(r.ns_per_hop, 0);
+	std::cout << std::setw(10) << percentile(r.ns_per_hop, 50);
+	std::cout << std::setw(10) << percentile(r.ns_per_hop, 90);
+	std::cout << std::setw(10) << percentile(r.ns_per_hop, 99);
+	std::cout << std::setw(10) << percentile(r.ns_per_hop, 100) << std::endl;
+    }
+}
+
+/* NUMA latency matrix
+ * ===================
+ *
+ * For every pair of a CPU node and a memory node, ns/hop along a chain
+ * in memory bound to the memory node, chased by a thread pinned to the
+ * first CPU of the CPU node. There is one chain per memory node, and
+ * all of them are built at once: each by a thread restricted to the
+ * CPUs of its memory node, along with the generator's worker threads
+ * (opts.threads of them, one per CPU of the node), which inherit that
+ * restriction. Memory-only nodes have their chains built anywhere. The
+ * chases run one at a time, so that they do not load the interconnect
+ * for each other; each one has a partial warm-up of at most hops hops,
+ * to keep the whole matrix within seconds.
+ */
+struct numa_options {
+    int64_t chain_bytes;
+    int64_t hops;
+    generator_options gen;
+
+    numa_options() : chain_bytes(256 << 20), hops(1 << 22) { }
+};
+
+template<class T> void numaMatrix(const numa_options & no) {
+
+    std::vector<numa_node_info> nodes = numa_nodes();
+    int M = (int) nodes.size();
+    int N = (int) std::min<int64_t>(no.chain_bytes / no.gen.node_bytes, INT_MAX);
+
+    std::vector< std::unique_ptr<T> > gens(M);
+    std::vector<uint64_t *> heads(M);
+    std::vector<double> generation_s(M);
+    std::vector<std::thread> builders;
+
+    for(int m = 0; m < M; m++) {
+	builders.push_back(std::thread([&, m]() {
+	    generator_options opts = no.gen;
+
+	    if(!nodes[m].cpus.empty()) {
+		pin_thread(nodes[m].cpus);
+		opts.threads = (int) nodes[m].cpus.size();
+	    }
+	    opts.alloc.numa_node = nodes[m].node;
+
+	    auto start = std::chrono::steady_clock::now();
+	    gens[m].reset(new T(N, opts));
+	    heads[m] = require_list(*gens[m]);
+	    auto end = std::chrono::steady_clock::now();
+
+	    generation_s[m] = std::chrono::duration<double>(end - start).count();
+	}));
+    }
+
+    for(std::thread & b : builders)
+	b.join();
+
+    std::cout << T::name() << ": " << gens[0]->list_bytes() << " bytes per chain, ";
+    std::cout << no.hops << " hops per chase" << std::endl;
+    for(int m = 0; m < M; m++) {
+	std::cout << "memory node " << nodes[m].node << ": chain built in ";
+	std::cout << generation_s[m] << " s" << std::endl;
+    }
+
+    std::cout << std::endl << std::setw(16) << "ns/hop";
+    for(int m = 0; m < M; m++)
+	std::cout << std::setw(10) << ("mem " + std::to_string(nodes[m].node));
+    std::cout << std::endl;
+
+    for(int c = 0; c < M; c++) {
+	if(nodes[c].cpus.empty())
+	    continue;
+
+	std::cout << std::setw(16) << ("cpu node " + std::to_string(nodes[c].node));
+
+	for(int m = 0; m < M; m++) {
+	    chase_result r;
+
+	    std::thread chaser([&]() {
+		pin_thread(nodes[c].cpus[0]);
+		r = timed_chase(heads[m], no.hops, std::min<int64_t>(N, no.hops));
+	    });
+	    chaser.join();
+
+	    std::cout << std::setw(10) << r.ns_per_hop << std::flush;
+	}
+
+	std::cout << std::endl;
+    }
+}
+
+/* Count hardware events in getlist() and in one chase over all N nodes
+ * (after a warm-up pass), and print them in total and per element. */
+template<class T> void profileGenerator(int N,
+	const generator_options & opts = generator_options()) {
+
+    perf_counters counters;
+    T gen(N, opts);
+
+    std::cout << T::name() << ": performance counters for " << N << " elements";
+    std::cout << " of " << gen.getNodeBytes() << " bytes" << std::endl;
+
+    counters.start();
+    uint64_t * head = require_list(gen);
+    counters.stop();
+    counters.print(std::cout, "getlist", N);
+
+    uint64_t * p = chase(head, N);
+
+    counters.start();
+    p = chase(p, N);
+    counters.stop();
+    counters.print(std::cout, "chase", N);
+
+    g_chase_sink = p;
+    std::cout << std::endl;
+}
+
+void bandwidthHeader() {
+    std::cout << std::setw(48) << "generator" << std::setw(14) << "bytes";
+    std::cout << std::setw(10) << "ns/hop";
+    std::cout << std::setw(10) << "fw read" << std::setw(10) << "rev read";
+    std::cout << std::setw(10) << "rnd read" << std::setw(10) << "rnd write";
+    std::cout << std::setw(10) << "fw write" << std::setw(10) << "rev write";
+    std::cout << "  [GB/s]" << std::endl;
+}
+
+/* Chase the chain built by T as measureLatency() does, then run X-Mem's
+ * throughput kernels over the same list (see bandwidth.h), and print
+ * one row of the bandwidth table (see bandwidthHeader()). The write
+ * kernels overwrite the list, so this is the last use of its chain. */
+template<class T> void measureBandwidth(int N,
+	const generator_options & opts = generator_options(),
+	int64_t min_hops = 1 << 24) {
+
+    T gen(N, opts);
+    uint64_t * head = require_list(gen);
+
+    chase_result c = timed_chase(head, std::max<int64_t>(N, min_hops), N);
+    bandwidth_result b = measure_bandwidth(head, gen.getBase(),
+	gen.list_bytes(), std::max<int64_t>(N, min_hops),
+	std::max<int64_t>(gen.list_bytes(), 1 << 30));
+
+    std::cout << std::setw(48) << T::name() << std::setw(14) << gen.list_bytes();
+    std::cout << std::setw(10) << c.ns_per_hop;
+    std::cout << std::setw(10) << b.forward_read << std::setw(10) << b.reverse_read;
+    std::cout << std::setw(10) << b.random_read << std::setw(10) << b.random_write;
+    std::cout << std::setw(10) << b.forward_write << std::setw(10) << b.reverse_write;
+    std::cout << std::endl;
+}
+
+/* Latency distribution
+ * ====================
+ *
+ * Chase the chain built by T for max(N, min_hops) hops after a warm-up
+ * pass, taking a sample of the time of every every-th hop (see
+ * sampled_chase()), net of the sampling overhead, and print percentiles
+ * of ns/hop over the samples: one row of the distribution table (see
+ * distributionHeader()) and, with spectrum, the whole spectrum. The
+ * ring holds RING_SAMPLES samples; we move them into the histogram after
+ * each round of that many, between timed chases. With every > 1, each
+ * sample is the mean over every hops, which blurs the distribution; but
+ * for chains that fit in the caches, the fence dominates samples of a
+ * single hop even after subtracting the overhead.
+ */
+static const int64_t RING_SAMPLES = 1 << 20;
+
+void distributionHeader() {
+    std::cout << std::setw(48) << "generator" << std::setw(14) << "bytes";
+    std::cout << std::setw(7) << "every" << std::setw(12) << "samples";
+    std::cout << std::setw(10) << "mean" << std::setw(10) << "p50";
+    std::cout << std::setw(10) << "p99" << std::setw(10) << "p99.9";
+    std::cout << std::setw(12) << "max" << "  [ns/hop]" << std::endl;
+}
+
+template<class T> void latencyDistribution(int N,
+	const generator_options & opts, int every, bool spectrum,
+	int64_t min_hops = 1 << 24) {
+
+    T gen(N, opts);
+    uint64_t * p = chase(require_list(gen), N);
+
+    every = std::max(every, 1);
+    int64_t hops = std::max<int64_t>(N, min_hops) + every - 1;
+    hops -= hops % every;
+
+    uint64_t overhead = sample_overhead();
+    sample_ring ring(RING_SAMPLES);
+    latency_histogram hist;
+    double ns = 0;
+    uint64_t ticks = 0;
+
+    for(int64_t done = 0; done < hops; ) {
+	int64_t round = std::min<int64_t>(hops - done, RING_SAMPLES * every);
+
+	ring.samples = 0;
+
+	auto start = std::chrono::steady_clock::now();
+	uint64_t t0 = read_fenced_ticks();
+	p = sampled_chase(p, round, every, ring);
+	uint64_t t1 = read_fenced_ticks();
+	auto end = std::chrono::steady_clock::now();
+
+	ns += std::chrono::duration<double, std::nano>(end - start).count();
+	ticks += t1 - t0;
+
+	for(int64_t i = 0; i < ring.samples; i++) {
+	    uint64_t v = ring.ticks[i];
+	    hist.add(v > overhead ? v - overhead : 0);
+	}
+
+	done += round;
+    }
+
+    g_chase_sink = p;
+
+    /* ns per hop, per tick of a sample */
+    double scale = ticks ? ns / ticks / every : 0;
+    double net_ticks = (double) ticks - (double) overhead * hist.count();
+
+    std::cout << std::setw(48) << T::name() << std::setw(14) << gen.list_bytes();
+    std::cout << std::setw(7) << every << std::setw(12) << hist.count();
+    std::cout << std::setw(10) << std::max(net_ticks, 0.0) * scale /
+	std::max<int64_t>(hist.count(), 1);
+    std::cout << std::setw(10) << hist.percentile(50) * scale;
+    std::cout << std::setw(10) << hist.percentile(99) * scale;
+    std::cout << std::setw(10) << hist.percentile(99.9) * scale;
+    std::cout << std::setw(12) << hist.max() * scale << std::endl;
+
+    if(spectrum) {
+	std::cout << std::endl;
+	hist.print(std::cout, scale, "ns/hop");
+	std::cout << std::endl;
+    }
+}
+
+struct summary {
+    double min;
+    double median;
+    double stddev; /* sample standard deviation, 0 for one value */
+
+    summary(std::vector<double> values) : min(0), median(0), stddev(0) {
+	size_t n = values.size();
+	if(!n)
+	    return;
+
+	std::sort(values.begin(), values.end());
+	min = values[0];
+	median = (n % 2) ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2;
+
+	double mean = 0, squares = 0;
+	for(double v : values)
+	    mean += v / n;
+	for(double v : values)
+	    squares += (v - mean) * (v - mean);
+	if(n > 1)
+	    stddev = std::sqrt(squares / (n - 1));
+    }
+};
+
+/* Regression benchmark
+ * ====================
+ *
+ * Each of BENCHMARK_GENERATORS, at each of BENCHMARK_SIZES, with fixed
+ * seeds; one line per generator and size of
+ *   generator,bytes,generation_s,peak_rss_bytes,coverage,ns_per_hop,
+ *   generation_stddev_s,ns_per_hop_stddev
+ * with the median generation time and ns/hop over the repetitions and
+ * their standard deviations, the peak RSS of the process while the
+ * generator exists, and the coverage (percent of nodes on the cycle
+ * through the head) of the first chain. The deviations recorded in the
+ * baseline widen the tolerance of each entry by its own noise.
+ * "testprog benchmark" compares that against a baseline file and fails
+ * on regressions beyond the tolerances, or records the baseline if
+ * there is none. X-Mem's own generator is left out, as its chains (and
+ * hence its coverage) vary from run to run.
+ */
+struct benchmark_result {
+    std::string generator;
+    int64_t bytes;
+    double generation_s;
+    double peak_rss_bytes;
+    double coverage;
+    double ns_per_hop;
+    double generation_stddev_s;
+    double ns_per_hop_stddev;
+};
+
+template<class T> benchmark_result benchmarkGenerator(int N,
+	const generator_options & opts, int repetitions) {
+
+    reset_peak_rss();
+
+    T gen(N, opts);
+    benchmark_result b;
+
+    b.generator = T::name();
+    b.bytes = gen.list_bytes();
+
+    std::vector<double> generation_s, ns_per_hop;
+
+    /* as in sampleGenerator(), but with the coverage of the first chain */
+    for(int r = 0; r < repetitions; r++) {
+	gen.reseed(opts.seed + r);
+
+	auto start = std::chrono::steady_clock::now();
+	uint64_t * head = require_list(gen);
+	auto end = std::chrono::steady_clock::now();
+
+	if(r == 0)
+	    b.coverage = 100.0 * find_cycle(head).lambda / N;
+
+	chase_result c = timed_chase(head, std::max<int64_t>(N, 1 << 24), N);
+
+	generation_s.push_back(std::chrono::duration<double>(end - start).count());
+	ns_per_hop.push_back(c.ns_per_hop);
+    }
+
+    summary g(generation_s), n(ns_per_hop);
+    b.generation_s = g.median;
+    b.generation_stddev_s = g.stddev;
+    b.ns_per_hop = n.median;
+    b.ns_per_hop_stddev = n.stddev;
+    b.peak_rss_bytes = (double) peak_rss_bytes();
+
+    return b;
+}
+
+/* The generators that can be selected by name on the command line, in
+ * every combination with the RNG policies (named as in T::name()). Each
+ * entry points to the instantiations of the test drivers for its type,
+ * so the drivers run fully specialized for it. */
+struct named_generator {
+    std::string name;
+    float (*test)(int N, bool printHist, const generator_options & opts,
+	int bins, histogram_scale_t scale);
+    std::vector<run_sample> (*sample)(int N, const generator_options & opts,
+	int64_t min_hops, int repetitions);
+    void (*sweep)(const sweep_options & so, std::ostream & csv);
+    void (*loaded)(const loaded_options & lo);
+    void (*profile)(int N, const generator_options & opts);
+    void (*bandwidth)(int N, const generator_options & opts, int64_t min_hops);
+    void (*distribution)(int N, const generator_options & opts, int every,
+	bool spectrum, int64_t min_hops);
+    benchmark_result (*benchmark)(int N, const generator_options & opts,
+	int repetitions);
+    void (*numa)(const numa_options & no);
+};
+
+#define NAMED_GENERATOR(T) \
+    { T::name(), testGenerator< T >, sampleGenerator< T >, sweep< T >, \
+      loadedLatency< T >, profileGenerator< T >, measureBandwidth< T >, \
+      latencyDistribution< T >, benchmarkGenerator< T >, numaMatrix< T > }
+
+#define NAMED_GENERATOR_RNGS(G) \
+    NAMED_GENERATOR(G<xoshiro256ss_rng>), \
+    NAMED_GENERATOR(G<splitmix64_rng>), \
+    NAMED_GENERATOR(G<pcg64_rng>), \
+    NAMED_GENERATOR(G<mt19937_64_rng>)
+
+static const named_generator named_generators[] = {
+    NAMED_GENERATOR_RNGS(sattolo_generator),
+    NAMED_GENERATOR_RNGS(external_shuffle_generator),
+    NAMED_GENERATOR_RNGS(parallel_shuffle_generator),
+    NAMED_GENERATOR_RNGS(blocked_shuffle_generator),
+    NAMED_GENERATOR_RNGS(page_window_generator),
+    NAMED_GENERATOR_RNGS(growing_generator),
+    NAMED_GENERATOR(feistel_generator),
+    NAMED_GENERATOR_RNGS(adversarial_generator),
+    NAMED_GENERATOR(XMem_list_generator),
+    NAMED_GENERATOR(XMem_spliced_list_generator),
+    NAMED_GENERATOR(cached_generator< sattolo_generator<> >),
+    NAMED_GENERATOR(cached_generator< blocked_shuffle_generator<> >),
+};
+
+const named_generator * find_generator(const char * name) {
+    for(const named_generator & g : named_generators)
+	if(g.name == name)
+	    return &g;
+
+    std::cerr << "unknown generator " << name << "; see testprog list";
+    std::cerr << std::endl;
+
+    return NULL;
+}
+
+/* byte count with an optional binary suffix: 32K, 6M, 4G */
+int64_t parse_size(const char * s) {
+    char * end;
+    int64_t size = strtoll(s, &end, 0);
+
+    switch(*end) {
+    case 'k': case 'K': return size << 10;
+    case 'm': case 'M': return size << 20;
+    case 'g': case 'G': return size << 30;
+    default: return size;
+    }
+}
+
+/* a node size from the command line, which must be a multiple of 8 bytes
+ * (one pointer per node); 0, after an error message, if it is not */
+int parse_node_bytes(const char * s) {
+    int64_t bytes = parse_size(s);
+
+    if(bytes < 8 || bytes % 8 || bytes > INT_MAX) {
+	std::cerr << "invalid node size " << s << ": must be a positive "
+	    "multiple of 8 bytes" << std::endl;
+	return 0;
+    }
+
+    return (int) bytes;
+}
+
+int sweepMain(int argc, char ** argv) {
+
+    if(argc < 1) {
+	std::cerr << "usage: testprog sweep <generator> [min_bytes [max_bytes "
+	    "[step [node_bytes [file.csv]]]]]" << std::endl;
+	return EXIT_FAILURE;
+    }
+
+    const named_generator * g = find_generator(argv[0]);
+    if(!g)
+	return EXIT_FAILURE;
+
+    sweep_options so;
+    if(argc > 1)
+	so.min_bytes = parse_size(argv[1]);
+    if(argc > 2)
+	so.max_bytes = parse_size(argv[2]);
+    if(argc > 3)
+	so.step = atof(argv[3]);
+    if(argc > 4) {
+	so.gen.node_bytes = parse_node_bytes(argv[4]);
+	if(!so.gen.node_bytes)
+	    return EXIT_FAILURE;
+    }
+
+    std::ofstream file;
+    if(argc > 5)
+	file.open(argv[5]);
+    std::ostream & csv = (argc > 5) ? file : std::cout;
+
+    csv << "generator,node_bytes,bytes,N,generation_s,ns_per_hop,ticks_per_hop" << std::endl;
+    g->sweep(so, csv);
+
+    return EXIT_SUCCESS;
+}
+
+int loadedMain(int argc, char ** argv) {
+
+    if(argc < 2) {
+	std::cerr << "usage: testprog loaded <generator> <chase_cpus> "
+	    "[hog_cpus|- [chain_bytes [hog_bytes [rw]]]]" << std::endl;
+	std::cerr << "CPU lists as in 0-3,8,10-11" << std::endl;
+	return EXIT_FAILURE;
+    }
+
+    const named_generator * g = find_generator(argv[0]);
+    if(!g)
+	return EXIT_FAILURE;
+
+    loaded_options lo;
+    lo.chase_cpus = parse_cpu_list(argv[1]);
+    if(argc > 2 && strcmp(argv[2], "-") != 0)
+	lo.hog_cpus = parse_cpu_list(argv[2]);
+    if(argc > 3)
+	lo.chain_bytes = parse_size(argv[3]);
+    if(argc > 4)
+	lo.hog_bytes = parse_size(argv[4]);
+    if(argc > 5)
+	lo.hog_writes = strcmp(argv[5], "rw") == 0;
+
+    g->loaded(lo);
+
+    return EXIT_SUCCESS;
+}
+
+int numaMain(int argc, char ** argv) {
+
+    const char * name = (argc > 0) ? argv[0] : "feistel";
+    if(strcmp(name, "-h") == 0 || strcmp(name, "--help") == 0) {
+	std::cerr << "usage: testprog numa [generator [chain_bytes [hops "
+	    "[node_bytes]]]]" << std::endl;
+	std::cerr << "(default feistel, which builds chains in parallel "
+	    "without scratch memory)" << std::endl;
+	return EXIT_SUCCESS;
+    }
+
+    const named_generator * g = find_generator(name);
+    if(!g)
+	return EXIT_FAILURE;
+
+    numa_options no;
+    if(argc > 1)
+	no.chain_bytes = parse_size(argv[1]);
+    if(argc > 2)
+	no.hops = std::max<int64_t>(parse_size(argv[2]), 1);
+    if(argc > 3) {
+	no.gen.node_bytes = parse_node_bytes(argv[3]);
+	if(!no.gen.node_bytes)
+	    return EXIT_FAILURE;
+    }
+
+    g->numa(no);
+
+    return EXIT_SUCCESS;
+}
+
+void mlpHeader() {
+    std::cout << std::setw(48) << "generator" << std::setw(12) << "N";
+    std::cout << std::setw(6) << "K";
+    std::cout << std::setw(12) << "Mhops/s";
+    std::cout << std::setw(10) << "ns/hop";
+    std::cout << std::setw(10) << "vs. K=1" << std::endl;
+}
+
+/* Split the chain built by T into K = 1, ..., max_K disjoint cycles,
+ * chase them in lockstep, and print the aggregate hop throughput for
+ * each K (see mlpHeader()). The throughput stops increasing once K
+ * exceeds the number of misses that can be outstanding at a time. */
+template<class T> void measureMLP(int N,
+	const generator_options & opts = generator_options(),
+	int max_K = MAX_LOCKSTEP_CHAINS, int64_t min_hops = 1 << 24) {
+
+    double base = 0;
+
+    for(int K = 1; K <= std::min(max_K, MAX_LOCKSTEP_CHAINS); K++) {
+	T gen(N, opts);
+	std::vector<uint64_t *> heads = gen.split(require_list(gen), K);
+	int64_t hops = std::max<int64_t>(N, min_hops) / heads.size();
+
+	chase_result r = timed_lockstep_chase(heads, hops, N / heads.size());
+	double rate = 1e3 / r.ns_per_hop; /* Mhops/s */
+
+	if(K == 1)
+	    base = rate;
+
+	std::cout << std::setw(48) << T::name() << std::setw(12) << N;
+	std::cout << std::setw(6) << heads.size();
+	std::cout << std::setw(12) << rate;
+	std::cout << std::setw(10) << r.ns_per_hop;
+	std::cout << std::setw(9) << (rate / base) << "x" << std::endl;
+    }
+}
+
+int profileMain(int argc, char ** argv) {
+
+    if(argc < 1) {
+	std::cerr << "usage: testprog profile <generator> [bytes [node_bytes]]" << std::endl;
+	return EXIT_FAILURE;
+    }
+
+    const named_generator * g = find_generator(argv[0]);
+    if(!g)
+	return EXIT_FAILURE;
+
+    generator_options opts;
+    int64_t bytes = 256 << 20;
+    if(argc > 1)
+	bytes = parse_size(argv[1]);
+    if(argc > 2) {
+	opts.node_bytes = parse_node_bytes(argv[2]);
+	if(!opts.node_bytes)
+	    return EXIT_FAILURE;
+    }
+
+    g->profile((int) std::min<int64_t>(bytes / opts.node_bytes, INT_MAX), opts);
+
+    return EXIT_SUCCESS;
+}
+
+int bandwidthMain(int argc, char ** argv) {
+
+    if(argc < 1) {
+	std::cerr << "usage: testprog bandwidth <generator> [bytes [node_bytes]]" << std::endl;
+	return EXIT_FAILURE;
+    }
+
+    const named_generator * g = find_generator(argv[0]);
+    if(!g)
+	return EXIT_FAILURE;
+
+    generator_options opts;
+    int64_t bytes = 256 << 20;
+    if(argc > 1)
+	bytes = parse_size(argv[1]);
+    if(argc > 2) {
+	opts.node_bytes = parse_node_bytes(argv[2]);
+	if(!opts.node_bytes)
+	    return EXIT_FAILURE;
+    }
+
+    bandwidthHeader();
+    g->bandwidth((int) std::min<int64_t>(bytes / opts.node_bytes, INT_MAX),
+	opts, 1 << 24);
+
+    return EXIT_SUCCESS;
+}
+
+int distributionMain(int argc, char ** argv) {
+
+    if(argc < 1) {
+	std::cerr << "usage: testprog distribution <generator> [min_bytes "
+	    "[max_bytes [every [node_bytes]]]]" << std::endl;
+	return EXIT_FAILURE;
+    }
+
+    const named_generator * g = find_generator(argv[0]);
+    if(!g)
+	return EXIT_FAILURE;
+
+    sweep_options so;
+    so.max_bytes = 256 << 20;
+    so.step = 4;
+    int every = 1;
+    if(argc > 1)
+	so.min_bytes = parse_size(argv[1]);
+    if(argc > 2)
+	so.max_bytes = parse_size(argv[2]);
+    if(argc > 3)
+	every = atoi(argv[3]);
+    if(argc > 4) {
+	so.gen.node_bytes = parse_node_bytes(argv[4]);
+	if(!so.gen.node_bytes)
+	    return EXIT_FAILURE;
+    }
+
+    /* a single size gets its whole spectrum */
+    std::vector<int> sizes = sweep_sizes(so);
+    distributionHeader();
+    for(int N : sizes)
+	g->distribution(N, so.gen, every, sizes.size() == 1, 1 << 24);
+
+    return EXIT_SUCCESS;
+}
+
+/* split a comma-separated list */
+std::vector<std::string> split_list(const char * list) {
+    std::vector<std::string> items;
+    std::istringstream in(list);
+    std::string item;
+
+    while(std::getline(in, item, ','))
+	if(!item.empty())
+	    items.push_back(item);
+
+    return items;
+}
+
+static const char * const BENCHMARK_GENERATORS[] = {
+    "sattolo", "external_shuffle", "parallel_shuffle", "blocked_shuffle",
+    "page_window", "growing", "feistel", "adversarial", "xmem_spliced"
+};
+
+static const int64_t BENCHMARK_SIZES[] = { 2 << 20, 64 << 20 };
+
+static const int BENCHMARK_REPETITIONS = 7;
+
+/* a time regresses if it exceeds the baseline both by the relative
+ * tolerance and by the absolute slack, plus spread standard deviations
+ * of the baseline entry: timer and scheduling noise dominate times of a
+ * few milliseconds or nanoseconds, and differ from entry to entry */
+struct benchmark_tolerances {
+    double time; /* relative, for generation_s and ns_per_hop */
+    double rss; /* relative */
+    double coverage; /* in percentage points */
+    double generation_slack_s;
+    double chase_slack_ns;
+    double spread;
+
+    benchmark_tolerances()
+	: time(0.25), rss(0.10), coverage(0.01), generation_slack_s(0.05),
+	  chase_slack_ns(20), spread(3) { }
+
+    bool slower(double t, double base, double stddev, double slack) const {
+	return t > std::max(base * (1 + time), base + slack) + spread * stddev;
+    }
+};
+
+void printBenchmarkResult(std::ostream & out, const benchmark_result & b) {
+    out << b.generator << "," << b.bytes << "," << b.generation_s << ",";
+    out << (int64_t) b.peak_rss_bytes << "," << b.coverage << ",";
+    out << b.ns_per_hop << "," << b.generation_stddev_s << ",";
+    out << b.ns_per_hop_stddev << std::endl;
+}
+
+/* the results in a baseline file, by generator and bytes; empty if there
+ * is no such file. Baselines without the deviations read as exact. */
+std::map<std::pair<std::string, int64_t>, benchmark_result>
+	readBenchmarkBaseline(const char * file) {
+    std::map<std::pair<std::string, int64_t>, benchmark_result> baseline;
+    std::ifstream in(file);
+    std::string line;
+
+    std::getline(in, line); /* the header */
+    while(std::getline(in, line)) {
+	std::vector<std::string> f = split_list(line.c_str());
+	if(f.size() != 6 && f.size() != 8)
+	    continue;
+
+	benchmark_result b { f[0], atoll(f[1].c_str()), atof(f[2].c_str()),
+	    atof(f[3].c_str()), atof(f[4].c_str()), atof(f[5].c_str()), 0, 0 };
+	if(f.size() == 8) {
+	    b.generation_stddev_s = atof(f[6].c_str());
+	    b.ns_per_hop_stddev = atof(f[7].c_str());
+	}
+	baseline[std::make_pair(b.generator, b.bytes)] = b;
+    }
+
+    return baseline;
+}
+
+/* print what regressed in b against base to std::cout; false if
+ * anything did */
+bool checkBenchmarkResult(const benchmark_result & b,
+	const benchmark_result & base, const benchmark_tolerances & tol) {
+    bool ok = true;
+    std::ostringstream why;
+
+    if(tol.slower(b.generation_s, base.generation_s, base.generation_stddev_s,
+	    tol.generation_slack_s)) {
+	why << " generation " << b.generation_s << " s (baseline ";
+	why << base.generation_s << " s)";
+	ok = false;
+    }
+    if(tol.slower(b.ns_per_hop, base.ns_per_hop, base.ns_per_hop_stddev,
+	    tol.chase_slack_ns)) {
+	why << " chase " << b.ns_per_hop << " ns/hop (baseline ";
+	why << base.ns_per_hop << " ns/hop)";
+	ok = false;
+    }
+    if(b.peak_rss_bytes > base.peak_rss_bytes * (1 + tol.rss)) {
+	why << " peak RSS " << (int64_t) b.peak_rss_bytes << " bytes (baseline ";
+	why << (int64_t) base.peak_rss_bytes << " bytes)";
+	ok = false;
+    }
+    if(b.coverage < base.coverage - tol.coverage) {
+	why << " coverage " << b.coverage << "% (baseline ";
+	why << base.coverage << "%)";
+	ok = false;
+    }
+
+    std::cout << std::setw(24) << b.generator << std::setw(14) << b.bytes;
+    std::cout << (ok ? "  ok" : "  REGRESSION:") << why.str() << std::endl;
+
+    return ok;
+}
+
+int benchmarkMain(int argc, char ** argv) {
+
+    if(argc < 1) {
+	std::cerr << "usage: testprog benchmark <baseline.csv> [time_tolerance "
+	    "[rss_tolerance [coverage_tolerance]]]" << std::endl;
+	std::cerr << "tolerances relative, e.g. 0.25 for +25%, except "
+	    "coverage_tolerance, in percentage points" << std::endl;
+	return EXIT_FAILURE;
+    }
+
+    benchmark_tolerances tol;
+    if(argc > 1)
+	tol.time = atof(argv[1]);
+    if(argc > 2)
+	tol.rss = atof(argv[2]);
+    if(argc > 3)
+	tol.coverage = atof(argv[3]);
+
+    std::map<std::pair<std::string, int64_t>, benchmark_result> baseline =
+	readBenchmarkBaseline(argv[0]);
+
+    generator_options opts;
+    std::vector<benchmark_result> results;
+
+    for(const char * name : BENCHMARK_GENERATORS) {
+	const named_generator * g = find_generator(name);
+	if(!g)
+	    return EXIT_FAILURE;
+
+	for(int64_t bytes : BENCHMARK_SIZES) {
+	    int N = (int) std::min<int64_t>(bytes / opts.node_bytes, INT_MAX);
+
+	    std::cerr << name << ": " << bytes << " bytes" << std::endl;
+	    results.push_back(g->benchmark(N, opts, BENCHMARK_REPETITIONS));
+	}
+    }
+
+    if(baseline.empty()) {
+	std::ofstream out(argv[0]);
+	out << "generator,bytes,generation_s,peak_rss_bytes,coverage,ns_per_hop,"
+	    "generation_stddev_s,ns_per_hop_stddev" << std::endl;
+	for(const benchmark_result & b : results)
+	    printBenchmarkResult(out, b);
+
+	if(!out) {
+	    std::cerr << "cannot write " << argv[0] << std::endl;
+	    return EXIT_FAILURE;
+	}
+
+	std::cout << "recorded the baseline in " << argv[0] << std::endl;
+	return EXIT_SUCCESS;
+    }
+
+    bool ok = true;
+
+    for(const benchmark_result & b : results) {
+	auto base = baseline.find(std::make_pair(b.generator, b.bytes));
+
+	if(base == baseline.end())
+	    std::cout << std::setw(24) << b.generator << std::setw(14) <<
+		b.bytes << "  not in the baseline" << std::endl;
+	else if(!checkBenchmarkResult(b, base->second, tol))
+	    ok = false;
+    }
+
+    std::cout << std::endl << "current results:" << std::endl;
+    for(const benchmark_result & b : results)
+	printBenchmarkResult(std::cout, b);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int testMain(int argc, char ** argv) {
+
+    if(argc < 1) {
+	std::cerr << "usage: testprog test <generator>|all [N [node_bytes "
+	    "[linear|log]]]" << std::endl;
+	return EXIT_FAILURE;
+    }
+
+    generator_options opts;
+    int N = 6 << 20;
+    histogram_scale_t scale = HIST_LINEAR;
+    if(argc > 1)
+	N = (int) std::min<int64_t>(parse_size(argv[1]), INT_MAX);
+    if(argc > 2) {
+	opts.node_bytes = parse_node_bytes(argv[2]);
+	if(!opts.node_bytes)
+	    return EXIT_FAILURE;
+    }
+    if(argc > 3 && strcmp(argv[3], "log") == 0)
+	scale = HIST_LOG;
+
+    if(strcmp(argv[0], "all") == 0) {
+	for(const named_generator & g : named_generators)
+	    g.test(N, true, opts, 20, scale);
+	return EXIT_SUCCESS;
+    }
+
+    const named_generator * g = find_generator(argv[0]);
+    if(!g)
+	return EXIT_FAILURE;
+
+    g->test(N, true, opts, 20, scale);
+
+    return EXIT_SUCCESS;
+}
+
+/* Benchmark runner
+ * ================
+ *
+ * testprog run [options]: for each selected generator and working-set
+ * size, build and chase the chain repeatedly (with seeds seed, seed + 1,
+ * ..., in the same memory), and report the minimum, median and
+ * standard deviation of the generation time and of the chase latency
+ * over the repetitions, as a table, as CSV, or as JSON.
+ */
+enum output_format_t {
+    FORMAT_HUMAN,
+    FORMAT_CSV,
+    FORMAT_JSON
+};
+
+struct run_options {
+    std::vector<const named_generator *> generators;
+    std::vector<int64_t> sizes; /* in bytes */
+    int repetitions;
+    int64_t min_hops;
+    output_format_t format;
+    generator_options gen;
+
+    run_options() : repetitions(5), min_hops(1 << 24), format(FORMAT_HUMAN) { }
+};
+
+/* the results for one generator and size */
+struct run_result {
+    std::string generator;
+    int node_bytes;
+    size_t bytes;
+    int N;
+    int repetitions;
+    summary generation_s;
+    summary ns_per_hop;
+};
+
+run_result runOne(const named_generator & g, int N, const run_options & ro) {
+    std::vector<double> generation, latency;
+    std::vector<run_sample> samples = g.sample(N, ro.gen, ro.min_hops,
+	ro.repetitions);
+
+    if(samples.empty())
+	return run_result { g.name, ro.gen.node_bytes, 0, N, 0,
+	    summary(generation), summary(latency) };
+
+    for(const run_sample & s : samples) {
+	generation.push_back(s.generation_s);
+	latency.push_back(s.chase.ns_per_hop);
+    }
+
+    return run_result { g.name, samples[0].node_bytes, samples[0].bytes, N,
+	ro.repetitions, summary(generation), summary(latency) };
+}
+
+void printRunHeader(std::ostream & out, output_format_t format) {
+    switch(format) {
+    case FORMAT_HUMAN:
+	out << std::setw(32) << "generator" << std::setw(6) << "node";
+	out << std::setw(14) << "bytes" << std::setw(6) << "reps";
+	out << std::setw(12) << "gen min" << std::setw(12) << "gen median";
+	out << std::setw(12) << "gen stddev" << std::setw(10) << "ns min";
+	out << std::setw(10) << "ns median" << std::setw(10) << "ns stddev";
+	out << std::endl;
+	break;
+    case FORMAT_CSV:
+	out << "generator,node_bytes,bytes,N,repetitions,"
+	    "generation_min_s,generation_median_s,generation_stddev_s,"
+	    "ns_per_hop_min,ns_per_hop_median,ns_per_hop_stddev" << std::endl;
+	break;
+    case FORMAT_JSON:
+	out << "[" << std::endl;
+	break;
+    }
+}
+
+/* generator names are plain identifiers with '/' and '_', so they need
+ * no escaping in CSV or JSON */
+void printRunResult(std::ostream & out, output_format_t format,
+	const run_result & r, bool first) {
+    switch(format) {
+    case FORMAT_HUMAN:
+	out << std::setw(32) << r.generator << std::setw(6) << r.node_bytes;
+	out << std::setw(14) << r.bytes << std::setw(6) << r.repetitions;
+	out << std::setw(12) << r.generation_s.min;
+	out << std::setw(12) << r.generation_s.median;
+	out << std::setw(12) << r.generation_s.stddev;
+	out << std::setw(10) << r.ns_per_hop.min;
+	out << std::setw(10) << r.ns_per_hop.median;
+	out << std::setw(10) << r.ns_per_hop.stddev << std::endl;
+	break;
+    case FORMAT_CSV:
+	out << r.generator << "," << r.node_bytes << "," << r.bytes << ",";
+	out << r.N << "," << r.repetitions << ",";
+	out << r.generation_s.min << "," << r.generation_s.median << ",";
+	out << r.generation_s.stddev << "," << r.ns_per_hop.min << ",";
+	out << r.ns_per_hop.median << "," << r.ns_per_hop.stddev << std::endl;
+	break;
+    case FORMAT_JSON:
+	out << (first ? "  " : ",\n  ");
+	out << "{\"generator\": \"" << r.generator << "\", ";
+	out << "\"node_bytes\": " << r.node_bytes << ", ";
+	out << "\"bytes\": " << r.bytes << ", \"N\": " << r.N << ", ";
+	out << "\"repetitions\": " << r.repetitions << ", ";
+	out << "\"generation_s\": {\"min\": " << r.generation_s.min;
+	out << ", \"median\": " << r.generation_s.median;
+	out << ", \"stddev\": " << r.generation_s.stddev << "}, ";
+	out << "\"ns_per_hop\": {\"min\": " << r.ns_per_hop.min;
+	out << ", \"median\": " << r.ns_per_hop.median;
+	out << ", \"stddev\": " << r.ns_per_hop.stddev << "}}";
+	break;
+    }
+}
+
+void printRunFooter(std::ostream & out, output_format_t format) {
+    if(format == FORMAT_JSON)
+	out << std::endl << "]" << std::endl;
+}
+
+void runUsage() {
+    std::cerr << "usage: testprog run [options]" << std::endl;
+    std::cerr << "  -g, --generators LIST  comma-separated names or all "
+	"(default sattolo); see testprog list" << std::endl;
+    std::cerr << "  -s, --sizes LIST       comma-separated working-set sizes "
+	"in bytes, e.g. 32K,6M,1G (default 256M)" << std::endl;
+    std::cerr << "  -r, --repetitions R    (default 5)" << std::endl;
+    std::cerr << "  -n, --node-bytes B     (default 8)" << std::endl;
+    std::cerr << "  -t, --threads T        for parallel generators "
+	"(default: all CPUs)" << std::endl;
+    std::cerr << "  -S, --seed S           seed of the first repetition" << std::endl;
+    std::cerr << "  -H, --hops H           minimum hops per chase "
+	"(default 16M)" << std::endl;
+    std::cerr << "  -p, --pages P          default, thp, 2M, or 1G" << std::endl;
+    std::cerr << "  -f, --format F         human, csv, or json "
+	"(default human)" << std::endl;
+    std::cerr << "  -o, --output FILE      (default standard output)" << std::endl;
+}
+
+int runMain(int argc, char ** argv) {
+
+    static const struct option long_options[] = {
+	{ "generators", required_argument, NULL, 'g' },
+	{ "sizes", required_argument, NULL, 's' },
+	{ "repetitions", required_argument, NULL, 'r' },
+	{ "node-bytes", required_argument, NULL, 'n' },
+	{ "threads", required_argument, NULL, 't' },
+	{ "seed", required_argument, NULL, 'S' },
+	{ "hops", required_argument, NULL, 'H' },
+	{ "pages", required_argument, NULL, 'p' },
+	{ "format", required_argument, NULL, 'f' },
+	{ "output", required_argument, NULL, 'o' },
+	{ "help", no_argument, NULL, 'h' },
+	{ NULL, 0, NULL, 0 }
+    };
+
+    run_options ro;
+    const char * generators = "sattolo";
+    const char * output = NULL;
+    int c;
+
+    /* argv[0] is "run" */
+    optind = 1;
+    while((c = getopt_long(argc, argv, "g:s:r:n:t:S:H:p:f:o:h",
+	    long_options, NULL)) != -1) {
+	switch(c) {
+	case 'g':
+	    generators = optarg;
+	    break;
+	case 's':
+	    for(const std::string & size : split_list(optarg))
+		ro.sizes.push_back(parse_size(size.c_str()));
+	    break;
+	case 'r':
+	    ro.repetitions = std::max(atoi(optarg), 1);
+	    break;
+	case 'n':
+	    ro.gen.node_bytes = parse_node_bytes(optarg);
+	    if(!ro.gen.node_bytes) {
+		runUsage();
+		return EXIT_FAILURE;
+	    }
+	    break;
+	case 't':
+	    ro.gen.threads = std::max(atoi(optarg), 1);
+	    break;
+	case 'S':
+	    ro.gen.seed = strtoull(optarg, NULL, 0);
+	    break;
+	case 'H':
+	    ro.min_hops = parse_size(optarg);
+	    break;
+	case 'p':
+	    if(strcmp(optarg, "thp") == 0)
+		ro.gen.alloc.pages = PAGES_THP;
+	    else if(strcmp(optarg, "2M") == 0)
+		ro.gen.alloc.pages = PAGES_HUGETLB_2MiB;
+	    else if(strcmp(optarg, "1G") == 0)
+		ro.gen.alloc.pages = PAGES_HUGETLB_1GiB;
+	    else if(strcmp(optarg, "default") != 0) {
+		runUsage();
+		return EXIT_FAILURE;
+	    }
+	    break;
+	case 'f':
+	    if(strcmp(optarg, "csv") == 0)
+		ro.format = FORMAT_CSV;
+	    else if(strcmp(optarg, "json") == 0)
+		ro.format = FORMAT_JSON;
+	    else if(strcmp(optarg, "human") != 0) {
+		runUsage();
+		return EXIT_FAILURE;
+	    }
+	    break;
+	case 'o':
+	    output = optarg;
+	    break;
+	default:
+	    runUsage();
+	    return (c == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+    }
+
+    if(optind < argc) {
+	runUsage();
+	return EXIT_FAILURE;
+    }
+
+    if(strcmp(generators, "all") == 0) {
+	for(const named_generator & g : named_generators)
+	    ro.generators.push_back(&g);
+    } else {
+	for(const std::string & name : split_list(generators)) {
+	    const named_generator * g = find_generator(name.c_str());
+	    if(!g)
+		return EXIT_FAILURE;
+	    ro.generators.push_back(g);
+	}
+    }
+
+    if(ro.sizes.empty())
+	ro.sizes.push_back(256 << 20);
+
+    std::ofstream file;
+    if(output) {
+	file.open(output);
+	if(!file) {
+	    std::cerr << "cannot write " << output << std::endl;
+	    return EXIT_FAILURE;
+	}
+    }
+    std::ostream & out = output ? file : std::cout;
+
+    bool first = true;
+    printRunHeader(out, ro.format);
+
+    for(const named_generator * g : ro.generators) {
+	for(int64_t bytes : ro.sizes) {
+	    int N = (int) std::min<int64_t>(bytes / ro.gen.node_bytes, INT_MAX);
+	    if(N < 2)
+		continue;
+
+	    run_result r = runOne(*g, N, ro);
+	    if(!r.repetitions) /* unsupported with these options */
+		continue;
+
+	    printRunResult(out, ro.format, r, first);
+	    first = false;
+	}
+    }
+
+    printRunFooter(out, ro.format);
+
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char ** argv) {
+
+    if(argc > 1 && strcmp(argv[1], "sweep") == 0)
+	return sweepMain(argc - 2, argv + 2);
+    if(argc > 1 && strcmp(argv[1], "loaded") == 0)
+	return loadedMain(argc - 2, argv + 2);
+    if(argc > 1 && strcmp(argv[1], "numa") == 0)
+	return numaMain(argc - 2, argv + 2);
+    if(argc > 1 && strcmp(argv[1], "profile") == 0)
+	return profileMain(argc - 2, argv + 2);
+    if(argc > 1 && strcmp(argv[1], "bandwidth") == 0)
+	return bandwidthMain(argc - 2, argv + 2);
+    if(argc > 1 && strcmp(argv[1], "distribution") == 0)
+	return distributionMain(argc - 2, argv + 2);
+    if(argc > 1 && strcmp(argv[1], "benchmark") == 0)
+	return benchmarkMain(argc - 2, argv + 2);
+    if(argc > 1 && strcmp(argv[1], "test") == 0)
+	return testMain(argc - 2, argv + 2);
+    if(argc > 1 && strcmp(argv[1], "run") == 0)
+	return runMain(argc - 1, argv + 1);
+    if(argc > 1 && strcmp(argv[1], "list") == 0) {
+	for(const named_generator & g : named_generators)
+	    std::cout << g.name << std::endl;
+	return EXIT_SUCCESS;
+    }
+
+
+    //testGenerator< external_shuffle_generator<> >(32<<20, true);
+    //speedrun<XMem_list_generator>(32 << 20);
+    //speedrun< external_shuffle_generator<> >(32 << 20);
+    //speedrun< sattolo_generator<> >(32 << 20);
+
+    testGenerator< external_shuffle_generator<> >(128, true);
+    testGenerator< external_shuffle_generator<> >(1024, true);
+    testGenerator< external_shuffle_generator<> >(6<<20, true);
+    testGenerator< external_shuffle_generator<> >(32<<20, true);
+
+    testGenerator< sattolo_generator<> >(128, true);
+    testGenerator< sattolo_generator<> >(1024, true);
+    testGenerator< sattolo_generator<> >(6<<20, true);
+    testGenerator< sattolo_generator<> >(32<<20, true);
+
+    testGenerator< parallel_shuffle_generator<> >(1024, true);
+    testGenerator< parallel_shuffle_generator<> >(6<<20, true);
+
+    testGenerator< blocked_shuffle_generator<> >(1024, true);
+    testGenerator< blocked_shuffle_generator<> >(6<<20, true);
+
+    testGenerator< growing_generator<> >(1024, true);
+    testGenerator< growing_generator<> >(6<<20, true);
+
+    testGenerator<feistel_generator>(1024, true);
+    testGenerator<feistel_generator>(6<<20, true);
+
+    testGenerator< adversarial_generator<> >(1024, true);
+    testGenerator< adversarial_generator<> >(6<<20, true);
+
+    testGenerator< sattolo_generator<> >(1024, true, generator_options(),
+	0, HIST_LOG);
+    testGenerator< page_window_generator<> >(6<<20, true, generator_options(),
+	0, HIST_LOG);
+
+    generator_options line_opts;
+    line_opts.node_bytes = cacheline_size();
+    testGenerator< sattolo_generator<> >(1024, true, line_opts);
+    testGenerator< sattolo_generator<> >(6<<20, true, line_opts);
+
+    generator_options window_opts;
+    window_opts.window_pages = 16;
+    testGenerator< page_window_generator<> >(6<<20, true, window_opts);
+    window_opts.page_bytes = PAGE_2MiB;
+    window_opts.window_pages = 1;
+    testGenerator< page_window_generator<> >(6<<20, true, window_opts);
+
+    generator_options index_opts;
+    index_opts.node_bytes = sizeof(uint32_t);
+    testIndexGenerator< sattolo_index_generator<uint32_t> >(1024, index_opts);
+    testIndexGenerator< sattolo_index_generator<uint32_t, true> >(6<<20, index_opts);
+    testIndexGenerator< sattolo_index_generator<uint64_t> >(6<<20);
+
+    generator_options thp_opts;
+    thp_opts.alloc.pages = PAGES_THP;
+    thp_opts.alloc.prefault = true;
+    testGenerator< sattolo_generator<> >(32<<20, true, thp_opts);
+
+    testGenerator<XMem_list_generator>(128, true);
+    testGenerator<XMem_list_generator>(1024, true);
+
+
+    testGenerator<XMem_list_generator>(6 << 20, true);
+    testGenerator<XMem_list_generator>(32 << 20, true);
+
+    generator_options chunk_opts;
+    chunk_opts.node_bytes = NODE_128b;
+#ifdef HAS_WORD_128
+    testGenerator<XMem_list_generator>(1024, true, chunk_opts);
+#endif
+
+    testGenerator<XMem_spliced_list_generator>(1024, true);
+    testGenerator<XMem_spliced_list_generator>(6 << 20, true);
+#ifdef HAS_WORD_128
+    testGenerator<XMem_spliced_list_generator>(1024, true, chunk_opts);
+#endif
+    /* testGenerator(6<<20, true); */
+    /* testGenerator(20<<20, true);
+    testGenerator(32<<20, true);
+    testGenerator(64<<20, true); */
+    /* testGenerator(128<<20, true); */
+    /* testGenerator(256<<20, true); */
+
+    /* the repetitions reuse one generator each, so that only the first
+     * run pays for faulting in the list and the scratch memory */
+    float sum = 0;
+    XMem_list_generator xmem_gen(2 << 20);
+    for(int i = 0; i < 100; i++)
+	sum += testGenerator(xmem_gen, DEFAULT_SEED + i, false);
+
+    sum /= 100;
+
+    float sum2 = 0;
+    external_shuffle_generator<> shuffle_gen(2 << 20);
+    for(int i = 0; i < 100; i++)
+	sum2 += testGenerator(shuffle_gen, DEFAULT_SEED + i, false);
+
+    sum2 /= 100;
+
+    float sum3 = 0;
+    XMem_spliced_list_generator spliced_gen(2 << 20);
+    for(int i = 0; i < 100; i++)
+	sum3 += testGenerator(spliced_gen, DEFAULT_SEED + i, false);
+
+    sum3 /= 100;
+
+    std::cout << std::endl << "X-Mem: for 2 MiB test case, average coverage of ";
+    std::cout << sum << "% (100 runs)" << std::endl;
+
+    std::cout << std::endl << "external shuffle: for 2 MiB test case, average coverage of ";
+    std::cout << sum2 << "% (100 runs)" << std::endl;
+
+    std::cout << std::endl << "X-Mem spliced: for 2 MiB test case, average coverage of ";
+    std::cout << sum3 << "% (100 runs)" << std::endl;
+
+    std::cout << std::endl;
+    speedrunHeader();
+    speedrun< sattolo_generator<> >(6 << 20);
+    speedrun< sattolo_generator<mt19937_64_rng> >(6 << 20);
+    speedrun< sattolo_generator<pcg64_rng> >(6 << 20);
+    speedrun< sattolo_generator<splitmix64_rng> >(6 << 20);
+    speedrun< external_shuffle_generator<mt19937_64_rng> >(6 << 20);
+    speedrun< parallel_shuffle_generator<> >(6 << 20);
+    speedrun< parallel_shuffle_generator<> >(32 << 20);
+    speedrun< sattolo_generator<> >(32 << 20);
+    speedrun< sattolo_generator<> >(32 << 20, thp_opts);
+    speedrun< blocked_shuffle_generator<> >(6 << 20);
+    speedrun< blocked_shuffle_generator<> >(32 << 20);
+    speedrun< growing_generator<> >(32 << 20);
+    speedrun<feistel_generator>(32 << 20);
+    speedrun< adversarial_generator<> >(6 << 20);
+    speedrun< adversarial_generator<> >(32 << 20);
+    speedrun<XMem_list_generator>(32 << 20);
+    speedrun<XMem_spliced_list_generator>(32 << 20);
+    /* the first run generates and stores the chain, the second loads it */
+    speedrun< cached_generator< sattolo_generator<> > >(32 << 20);
+    speedrun< cached_generator< sattolo_generator<> > >(32 << 20);
+
+    std::cout << std::endl;
+    latencyHeader();
+    for(int n = 1 << 10; n <= 32 << 20; n <<= 2)
+	measureLatency< sattolo_generator<> >(n);
+    for(int n = 1 << 10; n <= 32 << 20; n <<= 2)
+	measureLatency<XMem_list_generator>(n);
+    for(int n = 1 << 10; n <= 32 << 20; n <<= 2)
+	measureLatency< adversarial_generator<> >(n);
+    for(int n = 1 << 10; n <= 32 << 20; n <<= 2)
+	measureLatency< sattolo_generator<> >(n, line_opts);
+    for(int n = 1 << 10; n <= 32 << 20; n <<= 2)
+	measureIndexLatency< sattolo_index_generator<uint32_t> >(n, index_opts);
+    for(int n = 1 << 10; n <= 32 << 20; n <<= 2)
+	measureIndexLatency< sattolo_index_generator<uint32_t, true> >(n, index_opts);
+
+    std::cout << std::endl;
+    bandwidthHeader();
+    for(int n = 1 << 10; n <= 32 << 20; n <<= 4)
+	measureBandwidth< sattolo_generator<> >(n);
+    measureBandwidth< adversarial_generator<> >(32 << 20);
+    measureBandwidth<XMem_spliced_list_generator>(32 << 20);
+
+    std::cout << std::endl;
+    distributionHeader();
+    for(int n = 1 << 10; n <= 32 << 20; n <<= 2)
+	latencyDistribution< sattolo_generator<> >(n, generator_options(), 1,
+	    false);
+    latencyDistribution< sattolo_generator<> >(32 << 20, generator_options(),
+	1, true);
+
+    std::cout << std::endl;
+    mlpHeader();
+    measureMLP< sattolo_generator<> >(8 << 20);
+    measureMLP< sattolo_generator<> >(1 << 20, line_opts);
+
+    std::cout << std::endl;
+    profileGenerator< external_shuffle_generator<> >(32 << 20);
+    profileGenerator< sattolo_generator<> >(32 << 20);
+    profileGenerator<XMem_list_generator>(32 << 20);
 }
 
@@ -0,0 +1,122 @@
+#include <cstring>
+#include <iomanip>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "perf_counters.h"
+
+static int open_counter(uint32_t type, uint64_t config) {
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.inherit = 1; /* count worker threads, too */
+
+    /* count in the kernel as well (page faults!), if we may */
+    int fd = (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    if(fd < 0) {
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	fd = (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+
+    return fd;
+}
+
+perf_counters::perf_counters() {
+    const uint64_t dtlb_read_miss = PERF_COUNT_HW_CACHE_DTLB |
+	(PERF_COUNT_HW_CACHE_OP_READ << 8) |
+	(PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+    fds[PERF_CYCLES] = open_counter(PERF_TYPE_HARDWARE,
+	PERF_COUNT_HW_CPU_CYCLES);
+    fds[PERF_INSTRUCTIONS] = open_counter(PERF_TYPE_HARDWARE,
+	PERF_COUNT_HW_INSTRUCTIONS);
+    fds[PERF_LLC_MISSES] = open_counter(PERF_TYPE_HARDWARE,
+	PERF_COUNT_HW_CACHE_MISSES);
+    fds[PERF_DTLB_MISSES] = open_counter(PERF_TYPE_HW_CACHE, dtlb_read_miss);
+    fds[PERF_STALLED_CYCLES] = open_counter(PERF_TYPE_HARDWARE,
+	PERF_COUNT_HW_STALLED_CYCLES_BACKEND);
+    fds[PERF_PAGE_FAULTS] = open_counter(PERF_TYPE_SOFTWARE,
+	PERF_COUNT_SW_PAGE_FAULTS);
+
+    for(int e = 0; e < NUM_PERF_EVENTS; e++)
+	values[e] = 0;
+}
+
+perf_counters::~perf_counters() {
+    for(int e = 0; e < NUM_PERF_EVENTS; e++)
+	if(fds[e] >= 0)
+	    close(fds[e]);
+}
+
+bool perf_counters::available() const {
+    for(int e = 0; e < NUM_PERF_EVENTS; e++)
+	if(fds[e] >= 0)
+	    return true;
+
+    return false;
+}
+
+void perf_counters::start() {
+    for(int e = 0; e < NUM_PERF_EVENTS; e++) {
+	if(fds[e] >= 0) {
+	    ioctl(fds[e], PERF_EVENT_IOC_RESET, 0);
+	    ioctl(fds[e], PERF_EVENT_IOC_ENABLE, 0);
+	}
+    }
+}
+
+void perf_counters::stop() {
+    for(int e = 0; e < NUM_PERF_EVENTS; e++) {
+	if(fds[e] >= 0) {
+	    ioctl(fds[e], PERF_EVENT_IOC_DISABLE, 0);
+	    if(read(fds[e], &values[e], sizeof(values[e])) != sizeof(values[e]))
+		values[e] = 0;
+	}
+    }
+}
+
+const char * perf_counters::name(perf_event_t e) {
+    static const char * names[NUM_PERF_EVENTS] = {
+	"cycles", "instructions", "LLC misses", "dTLB read misses",
+	"stalled cycles (backend)", "page faults"
+    };
+
+    return names[e];
+}
+
+void perf_counters::print(std::ostream & out, const char * phase,
+	int64_t elements) const {
+
+    if(!available()) {
+	out << phase << ": no performance counters available" << std::endl;
+	return;
+    }
+
+    for(int i = 0; i < NUM_PERF_EVENTS; i++) {
+	perf_event_t e = (perf_event_t) i;
+
+	out << std::setw(12) << phase << std::setw(26) << name(e);
+
+	if(has(e)) {
+	    out << std::setw(16) << value(e);
+	    out << std::setw(12) << (double) value(e) / elements << " per element";
+	} else {
+	    out << std::setw(16) << "n/a";
+	}
+
+	out << std::endl;
+    }
+
+    if(has(PERF_CYCLES) && has(PERF_INSTRUCTIONS) && value(PERF_CYCLES))
+	out << std::setw(12) << phase << std::setw(26) << "IPC"
+	    << std::setw(16) << (double) value(PERF_INSTRUCTIONS) / value(PERF_CYCLES)
+	    << std::endl;
+}
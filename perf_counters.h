@@ -0,0 +1,53 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <cstdint>
+#include <iostream>
+
+/* Hardware performance counters
+ * =============================
+ *
+ * A set of perf_event_open counters for the calling thread and the
+ * threads it creates afterwards, to tell apart where a phase (e.g.,
+ * getlist() or the chase) spends its time: RNG and arithmetic show as
+ * instructions, the random accesses of the shuffle as LLC and dTLB
+ * misses and stalled cycles, first touch as page faults. Counters that
+ * the CPU or the kernel (see /proc/sys/kernel/perf_event_paranoid) do
+ * not support are left out.
+ */
+
+enum perf_event_t {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_LLC_MISSES,
+    PERF_DTLB_MISSES,
+    PERF_STALLED_CYCLES,
+    PERF_PAGE_FAULTS,
+    NUM_PERF_EVENTS
+};
+
+class perf_counters {
+    int fds[NUM_PERF_EVENTS];
+    uint64_t values[NUM_PERF_EVENTS];
+
+public:
+    perf_counters();
+    ~perf_counters();
+
+    /* whether any counter could be opened */
+    bool available() const;
+
+    void start();
+    void stop();
+
+    /* count in the last start()/stop() interval */
+    bool has(perf_event_t e) const { return fds[e] >= 0; }
+    uint64_t value(perf_event_t e) const { return values[e]; }
+
+    static const char * name(perf_event_t e);
+
+    /* one line per counter: the total and the count per element */
+    void print(std::ostream & out, const char * phase, int64_t elements) const;
+};
+
+#endif
@@ -0,0 +1,226 @@
+#ifndef RANDOMNESS_TESTS_H
+#define RANDOMNESS_TESTS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+
+#include "stride_histogram.h"
+
+/* Statistical tests of the strides of a chain
+ * ===========================================
+ *
+ * In a uniformly random cyclic permutation of N nodes, the successor of
+ * each node is uniformly distributed over the other N - 1 nodes, so a
+ * stride d (in nodes) has probability (N - |d|) / (N (N - 1)) for
+ * 0 < |d| < N, a triangle centered at 0. The tests take the strides one
+ * at a time, in chain order, and compare against that:
+ *
+ *  - a chi-square test of the stride distribution, over linear bins,
+ *    against the expected count of each bin, at a significance level
+ *    of 0.1%;
+ *  - the fraction of strides shorter than the prefetch window (a page,
+ *    by default), which must not exceed its expectation by more than 5
+ *    standard deviations: chains with too many short strides let the
+ *    prefetchers hide latency;
+ *  - the correlation of successive strides. Successive strides of a
+ *    random cycle share a node, which makes their correlation exactly
+ *    -1/2; regular patterns move it away from that by more than 5
+ *    standard errors.
+ *
+ * Strides are not quite independent of each other around a cycle, so
+ * these are approximations, but good ones for the sizes we test.
+ */
+
+class stride_tests {
+    int64_t N;
+    int64_t window; /* prefetch window, in nodes */
+    stride_histogram hist;
+
+    int64_t strides;
+    int64_t small;
+    bool has_previous;
+    int64_t previous;
+    double sum_products; /* of each stride and its predecessor */
+    double sum_first, sum_second; /* of the strides in these products */
+    double squares_first, squares_second;
+    int64_t products;
+
+    /* sum of |d| over d in [a; b) */
+    static double sum_abs(int64_t a, int64_t b) {
+	double s = 0;
+
+	if(a < 0) {
+	    int64_t hi = std::min<int64_t>(b, 0); /* -a down to -hi + 1 */
+	    s += ((double) -a * (-a + 1) - (double) -hi * (-hi + 1)) / 2;
+	}
+	if(b > 0) {
+	    int64_t lo = std::max<int64_t>(a, 0); /* lo to b - 1 */
+	    s += ((double) (b - 1) * b - (double) (lo - 1) * lo) / 2;
+	}
+
+	return s;
+    }
+
+    /* expected number of strides in [a; b), out of N */
+    double expected(int64_t a, int64_t b) const {
+	a = std::max<int64_t>(a, -N + 1);
+	b = std::min<int64_t>(b, N);
+	if(a >= b)
+	    return 0;
+
+	double nonzero = (double) (b - a) - ((a <= 0 && 0 < b) ? 1 : 0);
+
+	return (nonzero * N - sum_abs(a, b)) / (N - 1);
+    }
+
+    /* chi-square bins: about 64, with an expected count of at least about
+     * 8 in each, down to 2 bins for tiny chains */
+    static int chi_square_bins(int64_t N) {
+	return (int) std::max<int64_t>(std::min<int64_t>(64, N / 16), 2);
+    }
+
+public:
+    stride_tests(int64_t N, int node_bytes, int64_t window_bytes = 4096)
+	: N(std::max<int64_t>(N, 2)),
+	  window(std::max<int64_t>(window_bytes / node_bytes, 1)),
+	  hist(this->N, chi_square_bins(this->N)) {
+	reset();
+    }
+
+    void reset() {
+	hist.reset();
+	strides = small = products = 0;
+	has_previous = false;
+	previous = 0;
+	sum_products = 0;
+	sum_first = sum_second = squares_first = squares_second = 0;
+    }
+
+    void add(int64_t stride) {
+	hist.add(stride);
+	account(stride);
+    }
+
+    /* add(strides[i]) for 0 <= i < n, binning them in one batch */
+    void add_batch(const int64_t * strides, int n) {
+	hist.add_batch(strides, n);
+	for(int i = 0; i < n; i++)
+	    account(strides[i]);
+    }
+
+private:
+    /* everything but the histogram */
+    void account(int64_t stride) {
+	strides ++;
+
+	if(stride > -window && stride < window)
+	    small ++;
+
+	if(has_previous) {
+	    sum_products += (double) previous * stride;
+	    sum_first += previous;
+	    sum_second += stride;
+	    squares_first += (double) previous * previous;
+	    squares_second += (double) stride * stride;
+	    products ++;
+	}
+
+	previous = stride;
+	has_previous = true;
+    }
+
+public:
+
+    /* the chi-square statistic, scaling the expectation to the number of
+     * strides seen */
+    double chi_square() const {
+	double chi2 = 0;
+
+	for(int i = 0; i < hist.bins(); i++) {
+	    double e = expected(hist.lower(i), hist.upper(i)) * strides / N;
+	    double o = (double) hist.count(i);
+
+	    if(e > 0)
+		chi2 += (o - e) * (o - e) / e;
+	    else if(o > 0)
+		return INFINITY;
+	}
+
+	return chi2;
+    }
+
+    int degrees_of_freedom() const { return hist.bins() - 1; }
+
+    /* the 99.9% quantile of the chi-square distribution, after Wilson and
+     * Hilferty */
+    double chi_square_limit() const {
+	const double z = 3.090;
+	double k = degrees_of_freedom();
+	double t = 1 - 2 / (9 * k) + z * std::sqrt(2 / (9 * k));
+
+	return k * t * t * t;
+    }
+
+    double small_fraction() const {
+	return strides ? (double) small / strides : 0;
+    }
+
+    double expected_small_fraction() const {
+	return expected(-window + 1, window) / N;
+    }
+
+    double small_fraction_limit() const {
+	double p = expected_small_fraction();
+
+	return p + 5 * std::sqrt(p * (1 - p) / std::max<int64_t>(strides, 1));
+    }
+
+    /* Pearson correlation of successive strides */
+    double autocorrelation() const {
+	if(products < 2)
+	    return 0;
+
+	double n = products;
+	double cov = sum_products - sum_first * sum_second / n;
+	double v1 = squares_first - sum_first * sum_first / n;
+	double v2 = squares_second - sum_second * sum_second / n;
+
+	return (v1 > 0 && v2 > 0) ? cov / std::sqrt(v1 * v2) : 0;
+    }
+
+    /* successive differences of independent values have a lag-1
+     * correlation of -1/2 with a standard error of sqrt(1 / (2n)) */
+    double autocorrelation_tolerance() const {
+	return 5 * std::sqrt(0.5 / std::max<int64_t>(products, 1));
+    }
+
+    bool chi_square_passed() const { return chi_square() <= chi_square_limit(); }
+    bool small_passed() const { return small_fraction() <= small_fraction_limit(); }
+    bool autocorrelation_passed() const {
+	return std::fabs(autocorrelation() + 0.5) <= autocorrelation_tolerance();
+    }
+
+    bool passed() const {
+	return chi_square_passed() && small_passed() && autocorrelation_passed();
+    }
+
+    void print(std::ostream & out, int node_bytes) const {
+	out << "Chi-square of strides: " << chi_square() << " (limit ";
+	out << chi_square_limit() << " at " << degrees_of_freedom();
+	out << " degrees of freedom): ";
+	out << (chi_square_passed() ? "pass" : "FAIL") << std::endl;
+
+	out << "Strides under " << window * node_bytes << " bytes: ";
+	out << small_fraction() << " (expected " << expected_small_fraction();
+	out << ", limit " << small_fraction_limit() << "): ";
+	out << (small_passed() ? "pass" : "FAIL") << std::endl;
+
+	out << "Correlation of successive strides: " << autocorrelation();
+	out << " (expected -0.5 +- " << autocorrelation_tolerance() << "): ";
+	out << (autocorrelation_passed() ? "pass" : "FAIL") << std::endl;
+    }
+};
+
+#endif
@@ -0,0 +1,74 @@
+#include <cstdio>
+#include <cstring>
+
+#include <sys/resource.h>
+
+#include "resources.h"
+
+/* a field of /proc/self/status, in KiB, converted to bytes */
+static size_t status_bytes(const char * field) {
+    FILE * f = fopen("/proc/self/status", "r");
+    if(!f)
+	return 0;
+
+    char line[256];
+    size_t length = strlen(field), kib = 0;
+
+    while(fgets(line, sizeof(line), f))
+	if(strncmp(line, field, length) == 0 &&
+		sscanf(line + length, "%zu", &kib) == 1)
+	    break;
+
+    fclose(f);
+
+    return kib * 1024;
+}
+
+size_t peak_rss_bytes() {
+    return status_bytes("VmHWM:");
+}
+
+size_t rss_bytes() {
+    return status_bytes("VmRSS:");
+}
+
+bool reset_peak_rss() {
+    FILE * f = fopen("/proc/self/clear_refs", "w");
+    if(!f)
+	return false;
+
+    bool ok = fputs("5", f) >= 0;
+
+    return (fclose(f) == 0) && ok;
+}
+
+void phase_meter::start() {
+    struct rusage ru;
+
+    reset_peak_rss();
+    start_rss = rss_bytes();
+
+    getrusage(RUSAGE_SELF, &ru);
+    start_minor = ru.ru_minflt;
+    start_major = ru.ru_majflt;
+}
+
+phase_usage phase_meter::stop() const {
+    struct rusage ru;
+    phase_usage u;
+
+    getrusage(RUSAGE_SELF, &ru);
+    u.minor_faults = ru.ru_minflt - start_minor;
+    u.major_faults = ru.ru_majflt - start_major;
+    u.peak_rss_delta = (int64_t) peak_rss_bytes() - (int64_t) start_rss;
+
+    return u;
+}
+
+std::ostream & operator<<(std::ostream & out, const phase_usage & u) {
+    out << "peak RSS " << (u.peak_rss_delta < 0 ? "" : "+");
+    out << u.peak_rss_delta << " bytes, " << u.minor_faults << " minor and ";
+    out << u.major_faults << " major page faults";
+
+    return out;
+}
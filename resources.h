@@ -0,0 +1,44 @@
+#ifndef RESOURCES_H
+#define RESOURCES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+/* Resource usage of this process
+ * ==============================
+ */
+
+/* the peak resident set size (VmHWM) in bytes, 0 if unknown */
+size_t peak_rss_bytes();
+
+/* restart the peak resident set size from the current one; false if the
+ * kernel cannot (before Linux 4.0) */
+bool reset_peak_rss();
+
+/* the current resident set size (VmRSS) in bytes, 0 if unknown */
+size_t rss_bytes();
+
+/* Memory used in a phase of the run, e.g., by getlist(): the peak RSS
+ * over the phase above the RSS at its start, and the page faults (of
+ * all threads) in between. Phases do not nest, as each one restarts the
+ * peak RSS; without that, the peak is the one of the whole process. */
+struct phase_usage {
+    int64_t peak_rss_delta; /* bytes */
+    int64_t minor_faults;
+    int64_t major_faults;
+};
+
+class phase_meter {
+    size_t start_rss;
+    int64_t start_minor, start_major;
+
+public:
+    void start();
+    phase_usage stop() const;
+};
+
+/* "peak RSS +x bytes, y minor and z major page faults" */
+std::ostream & operator<<(std::ostream & out, const phase_usage & u);
+
+#endif
@@ -0,0 +1,164 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <cstdint>
+#include <random>
+
+/* Random number generator policies for the list generators
+ * ========================================================
+ *
+ * Every policy is constructed from a 64 bit seed and satisfies the
+ * UniformRandomBitGenerator requirements (result_type, min(), max(), and
+ * operator() returning 64 random bits), so it can be handed to the
+ * standard library as well as to bounded_rand() and rng_shuffle() below.
+ * name() identifies the policy in output and on the command line.
+ */
+
+/* splitmix64 (Steele, Lea, Flood): a single 64 bit word of state. Also
+ * used to expand seeds for the policies with larger state. */
+class splitmix64_rng {
+    uint64_t x;
+
+public:
+    typedef uint64_t result_type;
+
+    static const char * name() { return "splitmix64"; }
+
+    explicit splitmix64_rng(uint64_t seed) : x(seed) { }
+
+    static constexpr uint64_t min() { return 0; }
+    static constexpr uint64_t max() { return UINT64_MAX; }
+
+    uint64_t operator()() {
+	uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+    }
+};
+
+/* xoshiro256** (Blackman, Vigna) */
+class xoshiro256ss_rng {
+    uint64_t s[4];
+
+    static uint64_t rotl(uint64_t x, int k) {
+	return (x << k) | (x >> (64 - k));
+    }
+
+public:
+    typedef uint64_t result_type;
+
+    static const char * name() { return "xoshiro256ss"; }
+
+    explicit xoshiro256ss_rng(uint64_t seed) {
+	/* the state must not be all zero, which splitmix64 guarantees */
+	splitmix64_rng sm(seed);
+	for(int i = 0; i < 4; i++)
+	    s[i] = sm();
+    }
+
+    static constexpr uint64_t min() { return 0; }
+    static constexpr uint64_t max() { return UINT64_MAX; }
+
+    uint64_t operator()() {
+	uint64_t result = rotl(s[1] * 5, 7) * 9;
+	uint64_t t = s[1] << 17;
+
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = rotl(s[3], 45);
+
+	return result;
+    }
+};
+
+/* PCG64, i.e., PCG-XSL-RR 128/64 (O'Neill) */
+class pcg64_rng {
+    __uint128_t state;
+    __uint128_t inc;
+
+    static constexpr __uint128_t multiplier() {
+	return ((__uint128_t) 0x2360ed051fc65da4ULL << 64) |
+	    0x4385df649fccf645ULL;
+    }
+
+    void step() { state = state * multiplier() + inc; }
+
+public:
+    typedef uint64_t result_type;
+
+    static const char * name() { return "pcg64"; }
+
+    explicit pcg64_rng(uint64_t seed, uint64_t stream = 0xda3e39cb94b95bdbULL)
+	: state(0), inc(((__uint128_t) stream << 1) | 1) {
+	step();
+	state += seed;
+	step();
+    }
+
+    static constexpr uint64_t min() { return 0; }
+    static constexpr uint64_t max() { return UINT64_MAX; }
+
+    uint64_t operator()() {
+	step();
+	uint64_t x = (uint64_t) (state >> 64) ^ (uint64_t) state;
+	int rot = (int) (state >> 122);
+	return (x >> rot) | (x << ((-rot) & 63));
+    }
+};
+
+/* the Mersenne Twister, as used by X-Mem */
+class mt19937_64_rng {
+    std::mt19937_64 gen;
+
+public:
+    typedef uint64_t result_type;
+
+    static const char * name() { return "mt19937_64"; }
+
+    explicit mt19937_64_rng(uint64_t seed) : gen(seed) { }
+
+    static constexpr uint64_t min() { return 0; }
+    static constexpr uint64_t max() { return UINT64_MAX; }
+
+    uint64_t operator()() { return gen(); }
+};
+
+/* Derive the seed for one of several independent streams (e.g., one per
+ * worker thread) from a single seed. */
+inline uint64_t derive_seed(uint64_t seed, uint64_t stream) {
+    splitmix64_rng sm(seed ^ (stream * 0xd1342543de82ef95ULL));
+    return sm();
+}
+
+/* Uniformly distributed number in [0, range), using Lemire's nearly
+ * divisionless method: one multiplication in the common case, and a
+ * division only when the sample may need to be rejected. */
+template<class RNG> inline uint64_t bounded_rand(RNG & rng, uint64_t range) {
+    __uint128_t m = (__uint128_t) rng() * range;
+    uint64_t l = (uint64_t) m;
+
+    if(l < range) {
+	uint64_t threshold = -range % range;
+	while(l < threshold) {
+	    m = (__uint128_t) rng() * range;
+	    l = (uint64_t) m;
+	}
+    }
+
+    return (uint64_t) (m >> 64);
+}
+
+/* Fisher-Yates shuffle of [first, last), a drop-in for std::shuffle that
+ * draws with bounded_rand() instead of std::uniform_int_distribution. */
+template<class It, class RNG> void rng_shuffle(It first, It last, RNG & rng) {
+    int64_t n = last - first;
+
+    for(int64_t i = n - 1; i > 0; i--)
+	std::swap(first[i], first[ bounded_rand(rng, i + 1) ]);
+}
+
+#endif
@@ -0,0 +1,315 @@
+#include <cstdlib>
+#include <cstring>
+
+#include "simd_kernels.h"
+
+#if defined(__x86_64__)
+/* GCC 12's AVX-512 intrinsics start out from an undefined vector, which
+ * it then warns about when they are inlined into target("avx512f")
+ * functions (GCC bug 105593) */
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <immintrin.h>
+#define HAS_X86_SIMD
+#endif
+
+/* log2 of node_words, or -1 if it is no power of two */
+static int words_shift(int node_words) {
+    if(node_words < 1 || (node_words & (node_words - 1)))
+	return -1;
+
+    return __builtin_ctz(node_words);
+}
+
+/* scalar variants, also for the remainder of the vector loops */
+
+static void iota_u32_scalar(uint32_t * dst, int64_t begin, int64_t n,
+	uint32_t first) {
+    for(int64_t i = begin; i < n; i++)
+	dst[i] = first + (uint32_t) i;
+}
+
+static void iota_nodes_scalar(uint64_t * list, int64_t begin, int64_t n,
+	int node_words) {
+    for(int64_t i = begin; i < n; i++)
+	list[i * node_words] = i;
+}
+
+static void indices_to_pointers_scalar(uint64_t * list, int64_t begin,
+	int64_t n, int node_words) {
+    for(int64_t i = begin; i < n; i++)
+	list[i * node_words] =
+	    (uint64_t) (list + (int64_t) list[i * node_words] * node_words);
+}
+
+static void link_order_scalar(uint64_t * list, const uint32_t * order,
+	int64_t begin, int64_t n, int node_words) {
+    for(int64_t i = begin; i < n; i++)
+	list[(int64_t) order[i] * node_words] =
+	    (uint64_t) (list + (int64_t) order[i + 1] * node_words);
+}
+
+static void linear_bins_scalar(const int64_t * strides, int begin, int n,
+	int64_t offset, uint64_t multiplier, int64_t * bins) {
+    for(int i = begin; i < n; i++)
+	bins[i] = (int64_t) (((uint64_t) (strides[i] + offset) * multiplier) >> 32);
+}
+
+#ifdef HAS_X86_SIMD
+
+__attribute__((target("avx2")))
+static void iota_u32_avx2(uint32_t * dst, int64_t n, uint32_t first) {
+    __m256i v = _mm256_add_epi32(_mm256_set1_epi32(first),
+	_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    const __m256i step = _mm256_set1_epi32(8);
+    int64_t i = 0;
+
+    for(; i + 8 <= n; i += 8) {
+	_mm256_storeu_si256((__m256i *) (dst + i), v);
+	v = _mm256_add_epi32(v, step);
+    }
+
+    iota_u32_scalar(dst, i, n, first);
+}
+
+__attribute__((target("avx512f")))
+static void iota_u32_avx512(uint32_t * dst, int64_t n, uint32_t first) {
+    __m512i v = _mm512_add_epi32(_mm512_set1_epi32(first),
+	_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+    const __m512i step = _mm512_set1_epi32(16);
+    int64_t i = 0;
+
+    for(; i + 16 <= n; i += 16) {
+	_mm512_storeu_si512((void *) (dst + i), v);
+	v = _mm512_add_epi32(v, step);
+    }
+
+    iota_u32_scalar(dst, i, n, first);
+}
+
+/* contiguous nodes only */
+__attribute__((target("avx2")))
+static void iota_nodes_avx2(uint64_t * list, int64_t n) {
+    __m256i v = _mm256_setr_epi64x(0, 1, 2, 3);
+    const __m256i step = _mm256_set1_epi64x(4);
+    int64_t i = 0;
+
+    for(; i + 4 <= n; i += 4) {
+	_mm256_storeu_si256((__m256i *) (list + i), v);
+	v = _mm256_add_epi64(v, step);
+    }
+
+    iota_nodes_scalar(list, i, n, 1);
+}
+
+/* nodes of 2^shift words, scattered to their first words */
+__attribute__((target("avx512f")))
+static void iota_nodes_avx512(uint64_t * list, int64_t n, int shift) {
+    __m512i v = _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m512i step = _mm512_set1_epi64(8);
+    int64_t i = 0;
+
+    for(; i + 8 <= n; i += 8) {
+	if(shift == 0)
+	    _mm512_storeu_si512((void *) (list + i), v);
+	else
+	    _mm512_i64scatter_epi64(list, _mm512_slli_epi64(v, shift), v, 8);
+	v = _mm512_add_epi64(v, step);
+    }
+
+    iota_nodes_scalar(list, i, n, 1 << shift);
+}
+
+__attribute__((target("avx2")))
+static void indices_to_pointers_avx2(uint64_t * list, int64_t n) {
+    const __m256i base = _mm256_set1_epi64x((int64_t) list);
+    int64_t i = 0;
+
+    for(; i + 4 <= n; i += 4) {
+	__m256i v = _mm256_loadu_si256((const __m256i *) (list + i));
+	v = _mm256_add_epi64(base, _mm256_slli_epi64(v, 3));
+	_mm256_storeu_si256((__m256i *) (list + i), v);
+    }
+
+    indices_to_pointers_scalar(list, i, n, 1);
+}
+
+/* nodes of 2^shift words; gathers the indices from the first words of 8
+ * nodes at a time, and scatters the pointers back */
+__attribute__((target("avx512f")))
+static void indices_to_pointers_avx512(uint64_t * list, int64_t n, int shift) {
+    const __m512i base = _mm512_set1_epi64((int64_t) list);
+    const __m512i step = _mm512_set1_epi64((int64_t) 8 << shift);
+    __m512i where = _mm512_slli_epi64(_mm512_setr_epi64(0, 1, 2, 3, 4, 5, 6, 7),
+	shift);
+    int64_t i = 0;
+
+    for(; i + 8 <= n; i += 8) {
+	__m512i v;
+
+	if(shift == 0)
+	    v = _mm512_loadu_si512((const void *) (list + i));
+	else
+	    v = _mm512_i64gather_epi64(where, (const void *) list, 8);
+
+	v = _mm512_add_epi64(base, _mm512_slli_epi64(v, 3 + shift));
+
+	if(shift == 0)
+	    _mm512_storeu_si512((void *) (list + i), v);
+	else
+	    _mm512_i64scatter_epi64(list, where, v, 8);
+
+	where = _mm512_add_epi64(where, step);
+    }
+
+    indices_to_pointers_scalar(list, i, n, 1 << shift);
+}
+
+/* the nodes are at random, so we scatter; AVX2 has no scatter */
+__attribute__((target("avx512f")))
+static void link_order_avx512(uint64_t * list, const uint32_t * order,
+	int64_t n, int shift) {
+    const __m512i base = _mm512_set1_epi64((int64_t) list);
+    int64_t i = 0;
+
+    for(; i + 8 <= n; i += 8) {
+	__m512i from = _mm512_cvtepu32_epi64(
+	    _mm256_loadu_si256((const __m256i *) (order + i)));
+	__m512i to = _mm512_cvtepu32_epi64(
+	    _mm256_loadu_si256((const __m256i *) (order + i + 1)));
+
+	to = _mm512_add_epi64(base, _mm512_slli_epi64(to, 3 + shift));
+	_mm512_i64scatter_epi64(list, _mm512_slli_epi64(from, shift), to, 8);
+    }
+
+    link_order_scalar(list, order, i, n, 1 << shift);
+}
+
+/* _mm256_mul_epu32 multiplies the low 32 bits of each lane, which is all
+ * there is */
+__attribute__((target("avx2")))
+static void linear_bins_avx2(const int64_t * strides, int n, int64_t offset,
+	uint64_t multiplier, int64_t * bins) {
+    const __m256i o = _mm256_set1_epi64x(offset);
+    const __m256i m = _mm256_set1_epi64x(multiplier);
+    int i = 0;
+
+    for(; i + 4 <= n; i += 4) {
+	__m256i v = _mm256_loadu_si256((const __m256i *) (strides + i));
+	v = _mm256_mul_epu32(_mm256_add_epi64(v, o), m);
+	_mm256_storeu_si256((__m256i *) (bins + i), _mm256_srli_epi64(v, 32));
+    }
+
+    linear_bins_scalar(strides, i, n, offset, multiplier, bins);
+}
+
+__attribute__((target("avx512f")))
+static void linear_bins_avx512(const int64_t * strides, int n, int64_t offset,
+	uint64_t multiplier, int64_t * bins) {
+    const __m512i o = _mm512_set1_epi64(offset);
+    const __m512i m = _mm512_set1_epi64(multiplier);
+    int i = 0;
+
+    for(; i + 8 <= n; i += 8) {
+	__m512i v = _mm512_loadu_si512((const void *) (strides + i));
+	v = _mm512_mul_epu32(_mm512_add_epi64(v, o), m);
+	_mm512_storeu_si512((void *) (bins + i), _mm512_srli_epi64(v, 32));
+    }
+
+    linear_bins_scalar(strides, i, n, offset, multiplier, bins);
+}
+
+#endif
+
+static simd_level_t detect_simd_level() {
+    simd_level_t level = SIMD_SCALAR;
+
+#ifdef HAS_X86_SIMD
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2"))
+	level = SIMD_AVX2;
+    if(__builtin_cpu_supports("avx512f"))
+	level = SIMD_AVX512;
+#endif
+
+    const char * cap = getenv("SIMD_KERNELS");
+    if(cap) {
+	for(int l = SIMD_SCALAR; l <= SIMD_AVX512; l++)
+	    if(strcmp(cap, simd_level_name((simd_level_t) l)) == 0 && l < level)
+		level = (simd_level_t) l;
+    }
+
+    return level;
+}
+
+simd_level_t simd_level() {
+    static const simd_level_t level = detect_simd_level();
+
+    return level;
+}
+
+const char * simd_level_name(simd_level_t level) {
+    switch(level) {
+    case SIMD_AVX2: return "avx2";
+    case SIMD_AVX512: return "avx512";
+    default: return "scalar";
+    }
+}
+
+void iota_u32(uint32_t * dst, int64_t n, uint32_t first) {
+#ifdef HAS_X86_SIMD
+    switch(simd_level()) {
+    case SIMD_AVX512: return iota_u32_avx512(dst, n, first);
+    case SIMD_AVX2: return iota_u32_avx2(dst, n, first);
+    default: break;
+    }
+#endif
+    iota_u32_scalar(dst, 0, n, first);
+}
+
+void iota_nodes(uint64_t * list, int64_t n, int node_words) {
+#ifdef HAS_X86_SIMD
+    int shift = words_shift(node_words);
+
+    if(shift >= 0 && simd_level() == SIMD_AVX512)
+	return iota_nodes_avx512(list, n, shift);
+    if(shift == 0 && simd_level() == SIMD_AVX2)
+	return iota_nodes_avx2(list, n);
+#endif
+    iota_nodes_scalar(list, 0, n, node_words);
+}
+
+void indices_to_pointers(uint64_t * list, int64_t n, int node_words) {
+#ifdef HAS_X86_SIMD
+    int shift = words_shift(node_words);
+
+    if(shift >= 0 && simd_level() == SIMD_AVX512)
+	return indices_to_pointers_avx512(list, n, shift);
+    if(shift == 0 && simd_level() == SIMD_AVX2)
+	return indices_to_pointers_avx2(list, n);
+#endif
+    indices_to_pointers_scalar(list, 0, n, node_words);
+}
+
+void link_order(uint64_t * list, const uint32_t * order, int64_t n,
+	int node_words) {
+#ifdef HAS_X86_SIMD
+    int shift = words_shift(node_words);
+
+    if(shift >= 0 && simd_level() == SIMD_AVX512)
+	return link_order_avx512(list, order, n, shift);
+#endif
+    link_order_scalar(list, order, 0, n, node_words);
+}
+
+void linear_bins(const int64_t * strides, int n, int64_t offset,
+	uint64_t multiplier, int64_t * bins) {
+#ifdef HAS_X86_SIMD
+    switch(simd_level()) {
+    case SIMD_AVX512: return linear_bins_avx512(strides, n, offset, multiplier, bins);
+    case SIMD_AVX2: return linear_bins_avx2(strides, n, offset, multiplier, bins);
+    default: break;
+    }
+#endif
+    linear_bins_scalar(strides, 0, n, offset, multiplier, bins);
+}
@@ -0,0 +1,47 @@
+#ifndef SIMD_KERNELS_H
+#define SIMD_KERNELS_H
+
+#include <cstdint>
+
+/* Vectorized setup kernels
+ * ========================
+ *
+ * The sequential (non-random) passes of generation and validation, in
+ * AVX2 and AVX-512 variants, selected at run time for the CPU we run
+ * on. The environment variable SIMD_KERNELS caps the selection at
+ * "scalar", "avx2" or "avx512", e.g., to compare the variants. Each
+ * kernel has the same result in every variant.
+ */
+
+enum simd_level_t {
+    SIMD_SCALAR,
+    SIMD_AVX2,
+    SIMD_AVX512
+};
+
+simd_level_t simd_level();
+const char * simd_level_name(simd_level_t level);
+
+/* dst[i] = first + i, for 0 <= i < n */
+void iota_u32(uint32_t * dst, int64_t n, uint32_t first);
+
+/* the first word of each of n nodes of node_words words holds its own
+ * index */
+void iota_nodes(uint64_t * list, int64_t n, int node_words);
+
+/* replace the successor index in the first word of each of n nodes by a
+ * pointer to that node */
+void indices_to_pointers(uint64_t * list, int64_t n, int node_words);
+
+/* link node order[i] to node order[i+1], for 0 <= i < n, so order must
+ * have n + 1 elements */
+void link_order(uint64_t * list, const uint32_t * order, int64_t n,
+	int node_words);
+
+/* approximate linear bins (see stride_histogram.h):
+ * bins[i] = ((strides[i] + offset) * multiplier) >> 32, where each
+ * strides[i] + offset and multiplier lie in [0; 2^32) */
+void linear_bins(const int64_t * strides, int n, int64_t offset,
+	uint64_t multiplier, int64_t * bins);
+
+#endif
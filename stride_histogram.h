@@ -0,0 +1,168 @@
+#ifndef STRIDE_HISTOGRAM_H
+#define STRIDE_HISTOGRAM_H
+
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "simd_kernels.h"
+
+/* Streaming histogram of stride lengths
+ * =====================================
+ *
+ * Strides (in nodes) of a chain over N nodes lie in (-N; N). Each stride
+ * is binned as it is added, so the histogram needs memory proportional
+ * to the number of bins only.
+ *
+ * HIST_LINEAR splits [-N; N) into equally wide bins, with bin bounds
+ * truncated to integers. The bin index is computed in 32.32 fixed point
+ * (one multiplication and a shift, no division) and corrected against
+ * the truncated bounds. add_batch() computes the fixed-point bins of a
+ * batch of strides with SIMD kernels.
+ *
+ * HIST_LOG has one bin per power of two for each sign, plus one bin for
+ * stride 0: [1; 2), [2; 4), [4; 8), ..., and the same for negative
+ * strides. This resolves short strides, which matter to prefetchers,
+ * far better than linear bins.
+ */
+
+enum histogram_scale_t {
+    HIST_LINEAR,
+    HIST_LOG
+};
+
+class stride_histogram {
+    int64_t N;
+    histogram_scale_t scale;
+    int octaves; /* HIST_LOG: bins per sign */
+    uint64_t multiplier; /* HIST_LINEAR: bins / (2N), in 32.32 fixed point */
+
+    /* bin i counts strides in [bounds[i]; bounds[i+1]) */
+    std::vector<int64_t> bounds;
+    std::vector<int64_t> counts;
+
+    static int log2_floor(uint64_t x) {
+	return 63 - __builtin_clzll(x);
+    }
+
+public:
+    stride_histogram(int64_t N, int bins = 20,
+	    histogram_scale_t scale = HIST_LINEAR)
+	: N(std::max<int64_t>(N, 1)), scale(scale), octaves(0), multiplier(0) {
+
+	if(scale == HIST_LOG) {
+	    octaves = log2_floor(this->N) + 1;
+
+	    for(int k = octaves - 1; k >= 0; k--)
+		bounds.push_back(-((int64_t) 2 << k) + 1);
+	    bounds.push_back(0);
+	    for(int k = 0; k <= octaves; k++)
+		bounds.push_back((int64_t) 1 << k);
+	} else {
+	    bins = std::max(bins, 1);
+
+	    for(int i = 0; i <= bins; i++)
+		bounds.push_back((int64_t) (-this->N + (2.0 * this->N / bins) * i));
+
+	    multiplier = (((uint64_t) bins << 32) + 2 * this->N - 1) / (2 * this->N);
+	}
+
+	counts.assign(bounds.size() - 1, 0);
+    }
+
+    int bins() const { return (int) counts.size(); }
+    int64_t lower(int i) const { return bounds[i]; }
+    int64_t upper(int i) const { return bounds[i + 1]; }
+    int64_t count(int i) const { return counts[i]; }
+
+    int64_t total() const {
+	int64_t sum = 0;
+	for(int64_t c : counts)
+	    sum += c;
+	return sum;
+    }
+
+    int bin_of(int64_t stride) const {
+	int bin;
+
+	if(scale == HIST_LOG) {
+	    if(stride > 0)
+		return octaves + 1 + log2_floor(stride);
+	    if(stride < 0)
+		return octaves - 1 - log2_floor(-stride);
+	    return octaves;
+	}
+
+	bin = (int) (((uint64_t) (stride + N) * multiplier) >> 32);
+
+	return correct_bin(stride, bin);
+    }
+
+    /* HIST_LINEAR: the bin of stride, from its fixed-point estimate */
+    int correct_bin(int64_t stride, int bin) const {
+	bin = std::min(bin, bins() - 1);
+
+	while(bin > 0 && stride < bounds[bin])
+	    bin--;
+	while(bin < bins() - 1 && stride >= bounds[bin + 1])
+	    bin++;
+
+	return bin;
+    }
+
+    void add(int64_t stride) { counts[ bin_of(stride) ] ++; }
+
+    /* add(strides[i]) for 0 <= i < n */
+    void add_batch(const int64_t * strides, int n) {
+	static const int BATCH = 256;
+	int64_t guess[BATCH];
+
+	/* the kernel needs the multiplier in 32 bits, which fails only with
+	 * more bins than strides */
+	if(scale == HIST_LOG || multiplier >> 32) {
+	    for(int i = 0; i < n; i++)
+		add(strides[i]);
+	    return;
+	}
+
+	for(int done = 0; done < n; done += BATCH) {
+	    int m = std::min(BATCH, n - done);
+
+	    linear_bins(strides + done, m, N, multiplier, guess);
+
+	    for(int i = 0; i < m; i++)
+		counts[ correct_bin(strides[done + i], (int) guess[i]) ] ++;
+	}
+    }
+
+    void reset() { std::fill(counts.begin(), counts.end(), 0); }
+
+    /* one line per bin, with bounds in nodes and in bytes */
+    void print(std::ostream & out, int node_bytes) const {
+	int64_t maxAmount = 1;
+
+	for(int64_t c : counts)
+	    maxAmount = std::max(maxAmount, c);
+
+	for(int i = 0; i < bins(); i++) {
+	    out <<  "[" << std::setw(9) << lower(i) << ";";
+	    out << std::setw(9) << upper(i) << ") ";
+	    out <<  "[" << std::setw(12) << lower(i) * node_bytes << ";";
+	    out << std::setw(12) << upper(i) * node_bytes << ") ";
+
+	    int dots = (int) (40 * counts[i] / maxAmount);
+
+	    for(int j = 0; j < dots; j++)
+		out << '*';
+
+	    for(int j = 0; j < 40 - dots; j++)
+		out << ' ';
+
+	    out << " (" << counts[i] << ")" << std::endl;
+	}
+    }
+};
+
+#endif
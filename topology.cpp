@@ -0,0 +1,113 @@
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "topology.h"
+
+bool pin_thread(int cpu) {
+    cpu_set_t set;
+
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+bool pin_thread(const std::vector<int> & cpus) {
+    cpu_set_t set;
+
+    CPU_ZERO(&set);
+    for(int cpu : cpus)
+	CPU_SET(cpu, &set);
+
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+int current_numa_node() {
+    unsigned cpu, node;
+
+    if(syscall(SYS_getcpu, &cpu, &node, NULL))
+	return 0;
+
+    return (int) node;
+}
+
+std::vector<int> parse_cpu_list(const char * list) {
+    std::vector<int> cpus;
+    const char * p = list;
+
+    while(*p) {
+	char * end;
+	long first = strtol(p, &end, 10);
+
+	if(end == p)
+	    break;
+
+	long last = first;
+	if(*end == '-')
+	    last = strtol(end + 1, &end, 10);
+
+	for(long cpu = first; cpu <= last; cpu++)
+	    cpus.push_back((int) cpu);
+
+	p = end;
+	if(*p == ',')
+	    p++;
+	else
+	    break;
+    }
+
+    return cpus;
+}
+
+/* the first line of a sysfs file, without the newline; empty if there
+ * is no such file */
+static std::string read_line(const std::string & file) {
+    FILE * f = fopen(file.c_str(), "r");
+    if(!f)
+	return "";
+
+    char line[4096];
+    std::string s;
+
+    if(fgets(line, sizeof(line), f))
+	s = line;
+    fclose(f);
+
+    while(!s.empty() && (s.back() == '\n' || s.back() == ' '))
+	s.pop_back();
+
+    return s;
+}
+
+std::vector<numa_node_info> numa_nodes() {
+    const std::string sys = "/sys/devices/system/node/";
+    std::vector<numa_node_info> nodes;
+
+    /* node numbers are CPU lists, too */
+    for(int node : parse_cpu_list(read_line(sys + "online").c_str())) {
+	numa_node_info n;
+
+	n.node = node;
+	n.cpus = parse_cpu_list(read_line(sys + "node" + std::to_string(node) +
+	    "/cpulist").c_str());
+	nodes.push_back(n);
+    }
+
+    if(nodes.empty()) {
+	numa_node_info n;
+
+	n.node = 0;
+	for(unsigned cpu = 0; cpu < std::thread::hardware_concurrency(); cpu++)
+	    n.cpus.push_back((int) cpu);
+	nodes.push_back(n);
+    }
+
+    return nodes;
+}
@@ -0,0 +1,32 @@
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#include <vector>
+
+/* CPU and NUMA topology helpers
+ * =============================
+ */
+
+/* pin the calling thread to the given CPU; false if that fails */
+bool pin_thread(int cpu);
+
+/* restrict the calling thread to the given CPUs; threads it starts
+ * afterwards inherit that */
+bool pin_thread(const std::vector<int> & cpus);
+
+/* NUMA node of the CPU the calling thread runs on, 0 if unknown */
+int current_numa_node();
+
+/* parse a CPU list in the kernel's format, e.g., "0-3,8,10-11" */
+std::vector<int> parse_cpu_list(const char * list);
+
+struct numa_node_info {
+    int node;
+    std::vector<int> cpus; /* empty for memory-only nodes */
+};
+
+/* the online NUMA nodes, from /sys/devices/system/node; without NUMA
+ * support, node 0 with all CPUs */
+std::vector<numa_node_info> numa_nodes();
+
+#endif